@@ -29,9 +29,10 @@ int main(int argc, char* argv[])
    ofstream INPDOC;
    open_ofstream(INPMAP, inpmappath);
 
-   map<string, vector<double> > inpemb;
-   map<string, vector<double> > hypemb;
-   map<string, vector<double> > inpfilemb;
+   embtable_t inpemb;
+   embtable_t hypemb;
+   map<string, embrow_t> inpfilemb;
+   map<string, embrow_t> hypfilemb;
    int dim;
    read_binw2v(inpembpath, inpemb, dim);
    read_binw2v(hypembpath, hypemb, dim);
@@ -43,18 +44,21 @@ int main(int argc, char* argv[])
       tokens.insert(sent.begin(), sent.end());
    }
    for (auto it = tokens.begin(); it != tokens.end(); it++) {
-      auto jt = inpemb.find(*it);
-      if (jt != inpemb.end()) {
-         inpfilemb[*it] = jt->second;
+      auto i = inpemb.find(*it);
+      if (i >= 0) {
+         inpfilemb[*it] = inpemb.get_row(i);
       }
    }
+   for (size_t i = 0; i < hypemb.size(); i++) {
+      hypfilemb[hypemb.get_word(i)] = hypemb.get_row(i);
+   }
 
    string maxsim_str;
    double maxsim_scr=0.0;
    for (auto it = inpfilemb.begin(); it != inpfilemb.end(); it++) {
       auto inp_s = it->first;
       auto inp_v = it->second;
-      for (auto jt = hypemb.begin(); jt != hypemb.end(); jt++) {
+      for (auto jt = hypfilemb.begin(); jt != hypfilemb.end(); jt++) {
          auto hyp_s = jt->first;
          auto hyp_v = jt->second;
          double sim = 0.0;
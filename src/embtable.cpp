@@ -0,0 +1,362 @@
+/**
+ * @file embtable.cpp
+ * @brief Compact word embedding table
+ *
+ * @author agent
+ *
+ * Class implementation of embrow_t and embtable_t.
+ *
+ * Layout of the mmw2v file (native byte order, all offsets in bytes):
+ *    - header: magic "YISIEMB1" followed by the uint64 fields of
+ *      mmw2v_header_t
+ *    - rows: n x dimension float32, 64-byte aligned
+ *    - lens: n double, the lengths used to normalize the rows
+ *    - buckets: nbuckets uint64 open addressing index (row id + 1; 0 = empty)
+ *    - wordoffs: n + 1 uint64 offsets into the word pool
+ *    - words: the vocabulary, concatenated
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "embtable.h"
+#include "util.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace yisi;
+using namespace std;
+
+namespace {
+   const char MMW2V_MAGIC[8] = {'Y', 'I', 'S', 'I', 'E', 'M', 'B', '1'};
+
+   struct mmw2v_header_t {
+      char magic[8];
+      uint64_t n;
+      uint64_t dimension;
+      uint64_t nbuckets;
+      uint64_t rows_off;
+      uint64_t lens_off;
+      uint64_t buckets_off;
+      uint64_t wordoffs_off;
+      uint64_t words_off;
+      uint64_t words_size;
+      uint64_t file_size;
+   };
+
+   uint64_t align_up(uint64_t off, uint64_t a) {
+      return (off + a - 1) / a * a;
+   }
+
+   void write_padding(ofstream& os, uint64_t off) {
+      while ((uint64_t)os.tellp() < off) {
+         os.put('\0');
+      }
+   }
+
+   // whether count items of the given size and alignment fit at off in a
+   // file of file_size bytes, without overflow
+   bool fits(uint64_t off, uint64_t count, uint64_t size, uint64_t file_size) {
+      return off % size == 0 && off <= file_size && count <= (file_size - off) / size;
+   }
+
+   /*
+    * Whether the sections described by header lie within the file and are
+    * consistent with each other, so that no lookup reads outside the map.
+    */
+   bool check_header(const mmw2v_header_t& header, const char* base, uint64_t map_size) {
+      if (memcmp(header.magic, MMW2V_MAGIC, sizeof(MMW2V_MAGIC)) != 0
+          || header.file_size != map_size) {
+         return false;
+      }
+      // the probe masks the hash with nbuckets - 1 and stops at an empty
+      // bucket, so nbuckets is a power of two above n
+      if (header.dimension == 0 || header.dimension > (uint64_t)numeric_limits<int>::max()
+          || header.nbuckets == 0 || (header.nbuckets & (header.nbuckets - 1)) != 0
+          || header.nbuckets <= header.n
+          || header.n > numeric_limits<uint64_t>::max() / header.dimension) {
+         return false;
+      }
+      if (!fits(header.rows_off, header.n * header.dimension, sizeof(float), map_size)
+          || !fits(header.lens_off, header.n, sizeof(double), map_size)
+          || !fits(header.buckets_off, header.nbuckets, sizeof(uint64_t), map_size)
+          || !fits(header.wordoffs_off, header.n + 1, sizeof(uint64_t), map_size)
+          || !fits(header.words_off, header.words_size, 1, map_size)) {
+         return false;
+      }
+      const uint64_t* buckets = (const uint64_t*)(base + header.buckets_off);
+      uint64_t used = 0;
+      for (uint64_t h = 0; h < header.nbuckets; h++) {
+         if (buckets[h] > header.n) {
+            return false;
+         }
+         used += buckets[h] != 0;
+      }
+      if (used > header.n) {
+         return false;
+      }
+      const uint64_t* wordoffs = (const uint64_t*)(base + header.wordoffs_off);
+      if (wordoffs[0] != 0 || wordoffs[header.n] != header.words_size) {
+         return false;
+      }
+      for (uint64_t i = 0; i < header.n; i++) {
+         if (wordoffs[i + 1] < wordoffs[i]) {
+            return false;
+         }
+      }
+      return true;
+   }
+} // anonymous namespace
+
+vector<double> embrow_t::get_vector() const {
+   vector<double> result(size_m);
+   for (int i = 0; i < size_m; i++) {
+      result[i] = (*this)[i];
+   }
+   return result;
+}
+
+embtable_t::embtable_t() : dimension_m(0), n_m(0), nbuckets_m(0), unk_m(-1),
+   rows_p(NULL), lens_p(NULL), buckets_p(NULL), wordoffs_p(NULL), words_p(NULL),
+   map_p(NULL), map_size_m(0) {
+   wordoffs_m.push_back(0);
+}
+
+embtable_t::~embtable_t() {
+   unmap();
+}
+
+void embtable_t::unmap() {
+   if (map_p != NULL) {
+      munmap(map_p, map_size_m);
+      map_p = NULL;
+      map_size_m = 0;
+   }
+}
+
+void embtable_t::init(int dimension) {
+   unmap();
+   dimension_m = dimension;
+   n_m = 0;
+   nbuckets_m = 0;
+   unk_m = -1;
+   rows_m.clear();
+   lens_m.clear();
+   buckets_m.clear();
+   wordoffs_m.assign(1, 0);
+   words_m.clear();
+   rows_p = NULL;
+   lens_p = NULL;
+   buckets_p = NULL;
+   wordoffs_p = NULL;
+   words_p = NULL;
+}
+
+void embtable_t::add(const string& word, const float* v, double len) {
+   rows_m.insert(rows_m.end(), v, v + dimension_m);
+   lens_m.push_back(len);
+   words_m += word;
+   wordoffs_m.push_back(words_m.size());
+   n_m++;
+}
+
+size_t embtable_t::add_rows(const vector<string>& words) {
+   size_t first = n_m;
+   rows_m.resize((n_m + words.size()) * dimension_m, 0.0f);
+   lens_m.resize(n_m + words.size(), 0.0);
+   for (auto it = words.begin(); it != words.end(); it++) {
+      words_m += *it;
+      wordoffs_m.push_back(words_m.size());
+   }
+   n_m += words.size();
+   return first;
+}
+
+void embtable_t::finalize() {
+   // the word of a row that appears more than once is replaced by its
+   // last occurrence, as model[word] = embedding used to do
+   vector<bool> dead(n_m, false);
+   size_t ndead = 0;
+   for (int pass = 0; pass < 2; pass++) {
+      nbuckets_m = 8;
+      while (nbuckets_m < 2 * n_m) {
+         nbuckets_m <<= 1;
+      }
+      buckets_m.assign(nbuckets_m, 0);
+      uint64_t mask = nbuckets_m - 1;
+      for (size_t i = 0; i < n_m; i++) {
+         const char* w = words_m.data() + wordoffs_m[i];
+         size_t wn = wordoffs_m[i + 1] - wordoffs_m[i];
+         uint64_t h = hash_word(w, wn) & mask;
+         while (buckets_m[h] != 0) {
+            size_t j = buckets_m[h] - 1;
+            if (wordoffs_m[j + 1] - wordoffs_m[j] == wn
+                && memcmp(words_m.data() + wordoffs_m[j], w, wn) == 0) {
+               dead[j] = true;
+               ndead++;
+               break;
+            }
+            h = (h + 1) & mask;
+         }
+         buckets_m[h] = i + 1;
+      }
+      if (ndead == 0) {
+         break;
+      }
+      // compact the surviving rows and index them again
+      size_t k = 0;
+      string words;
+      vector<uint64_t> wordoffs(1, 0);
+      for (size_t i = 0; i < n_m; i++) {
+         if (!dead[i]) {
+            copy(rows_m.begin() + i * dimension_m, rows_m.begin() + (i + 1) * dimension_m,
+                 rows_m.begin() + k * dimension_m);
+            lens_m[k] = lens_m[i];
+            words.append(words_m, wordoffs_m[i], wordoffs_m[i + 1] - wordoffs_m[i]);
+            wordoffs.push_back(words.size());
+            k++;
+         }
+      }
+      n_m = k;
+      rows_m.resize(n_m * dimension_m);
+      lens_m.resize(n_m);
+      words_m.swap(words);
+      wordoffs_m.swap(wordoffs);
+      dead.assign(n_m, false);
+      ndead = 0;
+   }
+
+   rows_p = rows_m.data();
+   lens_p = lens_m.data();
+   buckets_p = buckets_m.data();
+   wordoffs_p = wordoffs_m.data();
+   words_p = words_m.data();
+   unk_m = find("<unk>");
+}
+
+void embtable_t::map_file(string path) {
+   init(0);
+   int fd = open(path.c_str(), O_RDONLY);
+   if (fd < 0) {
+      cerr << "ERROR: Failed to open w2v model. Exiting..." << endl;
+      exit(1);
+   }
+   struct stat st;
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mmw2v_header_t)) {
+      cerr << "ERROR: " << path << " is not a mmw2v model. Exiting..." << endl;
+      exit(1);
+   }
+   map_size_m = st.st_size;
+   map_p = mmap(NULL, map_size_m, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if (map_p == MAP_FAILED) {
+      map_p = NULL;
+      cerr << "ERROR: Failed to mmap w2v model. Exiting..." << endl;
+      exit(1);
+   }
+
+   const char* base = (const char*)map_p;
+   mmw2v_header_t header;
+   memcpy(&header, base, sizeof(header));
+   if (!check_header(header, base, map_size_m)) {
+      cerr << "ERROR: " << path << " is not a valid mmw2v model. Exiting..." << endl;
+      exit(1);
+   }
+   dimension_m = (int)header.dimension;
+   n_m = header.n;
+   nbuckets_m = header.nbuckets;
+   rows_p = (const float*)(base + header.rows_off);
+   lens_p = (const double*)(base + header.lens_off);
+   buckets_p = (const uint64_t*)(base + header.buckets_off);
+   wordoffs_p = (const uint64_t*)(base + header.wordoffs_off);
+   words_p = base + header.words_off;
+   unk_m = find("<unk>");
+}
+
+void embtable_t::write_mmw2v(string path) const {
+   mmw2v_header_t header;
+   memcpy(header.magic, MMW2V_MAGIC, sizeof(MMW2V_MAGIC));
+   header.n = n_m;
+   header.dimension = dimension_m;
+   header.nbuckets = nbuckets_m;
+   header.rows_off = align_up(sizeof(header), 64);
+   header.lens_off = align_up(header.rows_off + n_m * dimension_m * sizeof(float), 64);
+   header.buckets_off = align_up(header.lens_off + n_m * sizeof(double), 64);
+   header.wordoffs_off = align_up(header.buckets_off + nbuckets_m * sizeof(uint64_t), 64);
+   header.words_off = align_up(header.wordoffs_off + (n_m + 1) * sizeof(uint64_t), 64);
+   header.words_size = wordoffs_p[n_m];
+   header.file_size = header.words_off + header.words_size;
+
+   ofstream os(path.c_str(), ios::out | ios::binary);
+   if (!os) {
+      cerr << "ERROR: Failed to open file to write w2v model. No model written." << endl;
+      return;
+   }
+   os.write((const char*)&header, sizeof(header));
+   write_padding(os, header.rows_off);
+   os.write((const char*)rows_p, n_m * dimension_m * sizeof(float));
+   write_padding(os, header.lens_off);
+   os.write((const char*)lens_p, n_m * sizeof(double));
+   write_padding(os, header.buckets_off);
+   os.write((const char*)buckets_p, nbuckets_m * sizeof(uint64_t));
+   write_padding(os, header.wordoffs_off);
+   os.write((const char*)wordoffs_p, (n_m + 1) * sizeof(uint64_t));
+   write_padding(os, header.words_off);
+   os.write(words_p, header.words_size);
+   os.close();
+}
+
+long long embtable_t::find(const string& word) const {
+   if (nbuckets_m == 0) {
+      return -1;
+   }
+   uint64_t mask = nbuckets_m - 1;
+   uint64_t h = hash_word(word.data(), word.size()) & mask;
+   while (buckets_p[h] != 0) {
+      size_t i = buckets_p[h] - 1;
+      if (wordoffs_p[i + 1] - wordoffs_p[i] == word.size()
+          && memcmp(words_p + wordoffs_p[i], word.data(), word.size()) == 0) {
+         return (long long)i;
+      }
+      h = (h + 1) & mask;
+   }
+   return -1;
+}
+
+string embtable_t::get_word(size_t i) const {
+   return string(words_p + wordoffs_p[i], wordoffs_p[i + 1] - wordoffs_p[i]);
+}
+
+embrow_t embtable_t::get_wv(const string& word) const {
+   long long i = find(word);
+   if (i < 0) {
+      i = find(lowercase(word));
+   }
+   if (i < 0) {
+      i = unk_m;
+   }
+   if (i < 0) {
+      return embrow_t();
+   }
+   return get_row(i);
+}
+
+uint64_t yisi::hash_word(const char* s, size_t n) {
+   // 64-bit FNV-1a
+   uint64_t h = 14695981039346656037ULL;
+   for (size_t i = 0; i < n; i++) {
+      h ^= (unsigned char)s[i];
+      h *= 1099511628211ULL;
+   }
+   return h;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file embtable.h
+ * @brief Compact word embedding table
+ *
+ * @author agent
+ *
+ * Class definition of:
+ *    - embrow_t (read-only view of one word vector in a table)
+ *    - embtable_t (word vectors stored as a contiguous float32 matrix with
+ *      a hashed vocabulary index, either built in memory or mmap'ed from a
+ *      file written by write_mmw2v)
+ *
+ * The vectors are kept as read from the model together with their length,
+ * so that embrow_t::operator[] returns exactly the normalized value the
+ * former std::map<std::string, std::vector<double> > tables used to hold.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef EMBTABLE_H
+#define EMBTABLE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace yisi {
+
+   typedef std::unordered_set<std::string> wordset_type;
+
+   struct embrow_t {
+      embrow_t() : data_m(NULL), len_m(0.0), size_m(0) {}
+      embrow_t(const float* data, double len, int size) : data_m(data), len_m(len), size_m(size) {}
+      int size() const { return size_m; }
+      // normalized component, identical to the former vector<double> entry
+      double operator[](int i) const { return data_m[i] / len_m; }
+      std::vector<double> get_vector() const;
+
+      const float* data_m;
+      double len_m;
+      int size_m;
+   }; // struct embrow_t
+
+   class embtable_t {
+   public:
+      embtable_t();
+      ~embtable_t();
+
+      // in-memory construction: init, add rows, then finalize to build the index
+      void init(int dimension);
+      void add(const std::string& word, const float* v, double len);
+      // appends rows for words, to be filled through get_data and set_len;
+      // returns the id of the first new row
+      size_t add_rows(const std::vector<std::string>& words);
+      float* get_data(size_t i) { return &rows_m[i * dimension_m]; }
+      void set_len(size_t i, double len) { lens_m[i] = len; }
+      void finalize();
+
+      // memory-mapped construction from a file written by write_mmw2v
+      void map_file(std::string path);
+      void write_mmw2v(std::string path) const;
+
+      int get_dimension() const { return dimension_m; }
+      size_t size() const { return n_m; }
+      long long find(const std::string& word) const;
+      std::string get_word(size_t i) const;
+      embrow_t get_row(size_t i) const {
+         return embrow_t(rows_p + i * dimension_m, lens_p[i], dimension_m);
+      }
+      // exact word, then lowercased word, then <unk>; empty row if none exists
+      embrow_t get_wv(const std::string& word) const;
+
+   private:
+      embtable_t(const embtable_t&);
+      embtable_t& operator=(const embtable_t&);
+      void unmap();
+
+      int dimension_m;
+      size_t n_m;
+      uint64_t nbuckets_m;
+      long long unk_m;
+
+      // views used by all queries; they point either into the owned vectors
+      // below or into the mapped file
+      const float* rows_p;
+      const double* lens_p;
+      const uint64_t* buckets_p;
+      const uint64_t* wordoffs_p;
+      const char* words_p;
+
+      std::vector<float> rows_m;
+      std::vector<double> lens_m;
+      std::vector<uint64_t> buckets_m;
+      std::vector<uint64_t> wordoffs_m;
+      std::string words_m;
+
+      void* map_p;
+      size_t map_size_m;
+   }; // class embtable_t
+
+   uint64_t hash_word(const char* s, size_t n);
+
+} // yisi
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * @file embview.h
+ * @brief Views of contextual embeddings
+ *
+ * @author agent
+ *
+ * Class definition of:
+ *    - vecview_t (non-owning view of a vector of doubles)
+ *    - matview_t (non-owning view of consecutive embeddings of a sentence)
+ *
+ * A sentence stores its contextual embeddings once, back to back in float32
+ * like the rows of an embedding table, with the offset and length of each
+ * one; role fillers and phrasal similarities only pass views of them around,
+ * and their rows go through the same vectorized kernels as the w2v rows.
+ * A view is valid as long as the sentence it points into.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef EMBVIEW_H
+#define EMBVIEW_H
+
+#include "embtable.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace yisi {
+
+   struct vecview_t {
+      vecview_t() : data_m(NULL), size_m(0) {}
+      vecview_t(const double* data, size_t size) : data_m(data), size_m(size) {}
+      // views the whole vector, e.g. a phrase vector computed on the fly
+      vecview_t(const std::vector<double>& v) : data_m(v.data()), size_m(v.size()) {}
+      size_t size() const { return size_m; }
+      double operator[](size_t i) const { return data_m[i]; }
+
+      const double* data_m;
+      size_t size_m;
+   }; // struct vecview_t
+
+   struct matview_t {
+      matview_t() : data_m(NULL), offset_m(NULL), len_m(NULL), size_m(0) {}
+      // rows i of size offset[i + 1] - offset[i] starting at data + offset[i],
+      // of length len[i]
+      matview_t(const float* data, const size_t* offset, const double* len, size_t size)
+         : data_m(data), offset_m(offset), len_m(len), size_m(size) {}
+      size_t size() const { return size_m; }
+      embrow_t operator[](size_t i) const {
+         return embrow_t(data_m + offset_m[i], len_m[i], offset_m[i + 1] - offset_m[i]);
+      }
+
+      const float* data_m;
+      const size_t* offset_m;
+      const double* len_m;
+      size_t size_m;
+   }; // struct matview_t
+
+} // yisi
+
+#endif
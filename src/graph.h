@@ -33,11 +33,7 @@ namespace yisi {
 
       node_t() {}
       node_t(data_type& data):data_m(data) {}
-      node_t(const node_t& rhs) {
-         data_m = rhs.data_m;
-      }
-
-      data_type get_data() { return data_m; }
+      data_type get_data() const { return data_m; }
 
       void set_data(data_type& data) { data_m = data; }
 
@@ -54,15 +50,9 @@ namespace yisi {
       edge_t() {};
       edge_t(nid_type tail, nid_type head, label_type& label)
          :tail_m(tail), head_m(head), label_m(label) {}
-      edge_t(const edge_t& rhs) {
-         tail_m = rhs.tail_m;
-         head_m = rhs.head_m;
-         label_m = rhs.label_m;
-      }
-
-      nid_type get_head() { return head_m; }
-      nid_type get_tail() { return tail_m; }
-      label_type get_label() { return label_m; }
+      nid_type get_head() const { return head_m; }
+      nid_type get_tail() const { return tail_m; }
+      label_type get_label() const { return label_m; }
 
       void set_head(nid_type head) { head_m = head; }
       void set_tail(nid_type tail) { tail_m = tail; }
@@ -87,19 +77,6 @@ namespace yisi {
 
       /// Default constructor
       graph_t() {};
-      graph_t(const graph_t& rhs) {
-         nodes_m = rhs.nodes_m;
-         edges_m = rhs.edges_m;
-         incoming_m = rhs.incoming_m;
-         outgoing_m = rhs.outgoing_m;
-      }
-
-      void operator=(const graph_t& rhs) {
-         nodes_m = rhs.nodes_m;
-         edges_m = rhs.edges_m;
-         incoming_m = rhs.incoming_m;
-         outgoing_m = rhs.outgoing_m;
-      }
 
       nid_type new_node() {
          nodes_m.push_back(node_t<data_T>());
@@ -123,16 +100,16 @@ namespace yisi {
          return eid;
       }
 
-      nid_type get_edge_head(eid_type eid) { return edges_m.at(eid).get_head(); }
-      nid_type get_edge_tail(eid_type eid) { return edges_m.at(eid).get_tail(); }
-      label_type get_edge_label(eid_type eid) { return edges_m.at(eid).get_label(); }
+      nid_type get_edge_head(eid_type eid) const { return edges_m.at(eid).get_head(); }
+      nid_type get_edge_tail(eid_type eid) const { return edges_m.at(eid).get_tail(); }
+      label_type get_edge_label(eid_type eid) const { return edges_m.at(eid).get_label(); }
 
-      data_type get_node_data(nid_type nid) { return nodes_m.at(nid).get_data(); }
+      data_type get_node_data(nid_type nid) const { return nodes_m.at(nid).get_data(); }
 
-      std::size_t get_node_count() { return nodes_m.size(); }
+      std::size_t get_node_count() const { return nodes_m.size(); }
 
-      const std::vector<eid_type>& get_incoming_edges(nid_type nid){ return incoming_m.at(nid); }
-      const std::vector<eid_type>& get_outgoing_edges(nid_type nid){ return outgoing_m.at(nid); }
+      const std::vector<eid_type>& get_incoming_edges(nid_type nid) const { return incoming_m.at(nid); }
+      const std::vector<eid_type>& get_outgoing_edges(nid_type nid) const { return outgoing_m.at(nid); }
 
       // We don't support changes to graph topology once it is created at the moment
       // i.e. set_edge_head, set_edge_tail, delete_edge, delete_node are not suppported
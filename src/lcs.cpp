@@ -0,0 +1,130 @@
+/**
+ * @file lcs.cpp
+ * @brief Longest common substring
+ *
+ * @author agent
+ *
+ * Class implementation for the classes:
+ *    - lcs_t
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "lcs.h"
+
+using namespace yisi;
+using namespace std;
+
+uint32_t lcs_t::next_char(const string& s, size_t& i) const {
+   unsigned char c = s[i];
+   i++;
+   if (!utf8_m || c < 0xc0 || c >= 0xf8) {
+      return c;
+   }
+   int more = (c >= 0xf0) ? 3 : (c >= 0xe0) ? 2 : 1;
+   if (i + more > s.size()) {
+      return c;
+   }
+   uint32_t result = c & (0x3f >> more);
+   for (int k = 0; k < more; k++) {
+      unsigned char d = s[i + k];
+      if ((d & 0xc0) != 0x80) {
+         return c;
+      }
+      result = (result << 6) | (d & 0x3f);
+   }
+   i += more;
+   // above the code points, so that stray bytes never equal a decoded character
+   return result + 0x100;
+}
+
+int lcs_t::find_edge(int state, uint32_t c) const {
+   for (int e = states_m[state].edge_m; e >= 0; e = edges_m[e].next_m) {
+      if (edges_m[e].char_m == c) {
+         return e;
+      }
+   }
+   return -1;
+}
+
+void lcs_t::add_edge(int state, uint32_t c, int to) {
+   edge_t edge = {c, to, states_m[state].edge_m};
+   states_m[state].edge_m = edges_m.size();
+   edges_m.push_back(edge);
+}
+
+void lcs_t::set_word(const string& word, bool utf8) {
+   utf8_m = utf8;
+   n_m = 0;
+   states_m.clear();
+   edges_m.clear();
+   state_t root = {0, -1, -1};
+   states_m.push_back(root);
+   int last = 0;
+   for (size_t i = 0; i < word.size();) {
+      uint32_t c = next_char(word, i);
+      n_m++;
+      int cur = states_m.size();
+      state_t state = {states_m[last].len_m + 1, -1, -1};
+      states_m.push_back(state);
+      int p = last;
+      while (p >= 0 && find_edge(p, c) < 0) {
+         add_edge(p, c, cur);
+         p = states_m[p].link_m;
+      }
+      if (p < 0) {
+         states_m[cur].link_m = 0;
+      } else {
+         int q = edges_m[find_edge(p, c)].to_m;
+         if (states_m[p].len_m + 1 == states_m[q].len_m) {
+            states_m[cur].link_m = q;
+         } else {
+            int clone = states_m.size();
+            state_t cloned = {states_m[p].len_m + 1, states_m[q].link_m, -1};
+            states_m.push_back(cloned);
+            for (int e = states_m[q].edge_m; e >= 0; e = edges_m[e].next_m) {
+               add_edge(clone, edges_m[e].char_m, edges_m[e].to_m);
+            }
+            int e;
+            while (p >= 0 && (e = find_edge(p, c)) >= 0 && edges_m[e].to_m == q) {
+               edges_m[e].to_m = clone;
+               p = states_m[p].link_m;
+            }
+            states_m[q].link_m = clone;
+            states_m[cur].link_m = clone;
+         }
+      }
+      last = cur;
+   }
+}
+
+size_t lcs_t::match(const string& other, size_t& other_n) const {
+   size_t result = 0;
+   size_t len = 0;
+   int state = 0;
+   other_n = 0;
+   for (size_t i = 0; i < other.size();) {
+      uint32_t c = next_char(other, i);
+      other_n++;
+      while (state != 0 && find_edge(state, c) < 0) {
+         state = states_m[state].link_m;
+         len = states_m[state].len_m;
+      }
+      int e = find_edge(state, c);
+      if (e >= 0) {
+         state = edges_m[e].to_m;
+         len++;
+      } else {
+         state = 0;
+         len = 0;
+      }
+      if (len > result) {
+         result = len;
+      }
+   }
+   return result;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file lcs.h
+ * @brief Longest common substring
+ *
+ * @author agent
+ *
+ * Class definition of:
+ *    - lcs_t (suffix automaton of a word, matched against other words)
+ * used by the lcs lex sim model (YiSi-0).
+ *
+ * set_word builds the automaton in time linear in the length of the word and
+ * match finds the longest common substring with another word in time linear
+ * in the length of that word. The states and transitions are kept across
+ * words, so a reused lcs_t no longer allocates once it has seen its longest
+ * word. Characters are bytes, or UTF-8 code points if requested; an invalid
+ * or truncated UTF-8 sequence counts each of its bytes as one character.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef LCS_H
+#define LCS_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace yisi {
+
+   class lcs_t {
+   public:
+      lcs_t() : utf8_m(false), n_m(0) {}
+      void set_word(const std::string& word, bool utf8 = false);
+      // length of the word, in characters
+      size_t size() const { return n_m; }
+      // length of the longest common substring of the word and other;
+      // other_n is set to the length of other, in characters
+      size_t match(const std::string& other, size_t& other_n) const;
+   private:
+      struct state_t {
+         int len_m;
+         int link_m;
+         int edge_m;
+      };
+      struct edge_t {
+         uint32_t char_m;
+         int to_m;
+         int next_m;
+      };
+      uint32_t next_char(const std::string& s, size_t& i) const;
+      int find_edge(int state, uint32_t c) const;
+      void add_edge(int state, uint32_t c, int to);
+
+      bool utf8_m;
+      size_t n_m;
+      std::vector<state_t> states_m;
+      // outgoing transitions of a state, linked from state_t::edge_m
+      std::vector<edge_t> edges_m;
+   }; // class lcs_t
+
+} // yisi
+
+#endif
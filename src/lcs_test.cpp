@@ -0,0 +1,87 @@
+/**
+ * @file lcs_test.cpp
+ * @brief Unit test for lcs.
+ *
+ * @author agent
+ *
+ * Checks the longest common substrings found by the suffix automaton
+ * against a plain search over all the substrings, on random words over a
+ * small alphabet, and on UTF-8 words counted in bytes and in code points.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "lcs.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace yisi;
+
+size_t brute_lcs(const string& a, const string& b) {
+   size_t result = 0;
+   for (size_t i = 0; i < a.size(); i++) {
+      for (size_t j = result + 1; i + j <= a.size() && b.find(a.substr(i, j)) != string::npos; j++) {
+         result = j;
+      }
+   }
+   return result;
+}
+
+int main(int argc, char* argv[])
+{
+   lcs_t lcs;
+   srand(1);
+   bool ok = true;
+   for (int t = 0; t < 2000; t++) {
+      string a;
+      string b;
+      int an = rand() % 20;
+      int bn = rand() % 20;
+      for (int i = 0; i < an; i++) {
+         a += (char)('a' + rand() % 3);
+      }
+      for (int i = 0; i < bn; i++) {
+         b += (char)('a' + rand() % 3);
+      }
+      lcs.set_word(a);
+      size_t bsize;
+      size_t l = lcs.match(b, bsize);
+      if (l != brute_lcs(a, b) || lcs.size() != a.size() || bsize != b.size()) {
+         cout << "random `" << a << "' `" << b << "': FAILED" << endl;
+         ok = false;
+      }
+   }
+   cout << "random: " << (ok ? "OK" : "FAILED") << endl;
+
+   const char* pairs[][2] = {
+      {"Donaudampfschifffahrt", "Dampfschiff"},
+      {"größer", "größte"},
+      {"naïve", "naive"},
+      {"日本語", "本語の"},
+      {"", "abc"},
+   };
+   for (size_t p = 0; p < sizeof(pairs) / sizeof(pairs[0]); p++) {
+      string a = pairs[p][0];
+      string b = pairs[p][1];
+      size_t bsize;
+      lcs.set_word(a);
+      size_t bytes = lcs.match(b, bsize);
+      size_t asize = lcs.size();
+      cout << "`" << a << "' `" << b << "': bytes " << bytes << "/" << asize << "/" << bsize;
+      lcs.set_word(a, true);
+      size_t chars = lcs.match(b, bsize);
+      cout << ", code points " << chars << "/" << lcs.size() << "/" << bsize << endl;
+      if (bytes != brute_lcs(a, b)) {
+         ok = false;
+      }
+   }
+
+   return ok ? 0 : 1;
+}
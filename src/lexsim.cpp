@@ -25,10 +25,146 @@
 #include <fstream>
 #include <math.h>
 #include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace yisi;
 using namespace std;
 
+namespace {
+   struct txtw2v_line_t {
+      string word_m;
+      const char* fields_m;
+      const char* eol_m;
+   };
+
+   txtw2v_line_t make_txtw2v_line(const char* p, const char* eol) {
+      txtw2v_line_t line;
+      const char* q = find(p, eol, ' ');
+      line.word_m.assign(p, q - p);
+      line.fields_m = (q < eol) ? q + 1 : eol;
+      line.eol_m = eol;
+      return line;
+   }
+
+   // atof of the field [p, end) without copying it
+   float parse_field(const char* p, const char* end) {
+      if (p == end) {
+         return 0.0f;
+      }
+      char* stop;
+      double v = strtod(p, &stop);
+      if (stop > end) {
+         // the field only held white space; strtod went on into the next one
+         return 0.0f;
+      }
+      return (float)v;
+   }
+
+   // fills row with the components of a line and returns its length, exactly
+   // as the former getline/atof parser did
+   double parse_txtw2v_row(const txtw2v_line_t& line, int dimension, float* row) {
+      const char* p = line.fields_m;
+      const char* eol = line.eol_m;
+      double len = 0.0;
+      for (int j = 0; j < dimension - 1; j++) {
+         const char* q = find(p, eol, ' ');
+         float f = parse_field(p, q);
+         row[j] = f;
+         len += f * f;
+         p = (q < eol) ? q + 1 : eol;
+      }
+      if (dimension > 0) {
+         float f = parse_field(p, eol);
+         row[dimension - 1] = f;
+         len += f * f;
+      }
+      return sqrt(len);
+   }
+
+   template <class F> void run_parallel(size_t n, F f) {
+      vector<thread> threads;
+      for (size_t k = 1; k < n; k++) {
+         threads.push_back(thread(f, k));
+      }
+      f(0);
+      for (auto it = threads.begin(); it != threads.end(); it++) {
+         it->join();
+      }
+   }
+
+   // mode of yisi::cosine behind a cosine similarity function, -1 otherwise
+   int get_cosine_mode(simfunc_type func) {
+      switch (func) {
+      case UCOSINE_FUNC:
+         return 0;
+      case COSINE_FUNC:
+         return 1;
+      case TCOSINE_FUNC:
+         return 2;
+      default:
+         return -1;
+      }
+   }
+
+   // cosines of all the pairs of rows into out[i * hyprows.size() + j] from
+   // one blocked product; pairs with a row of another dimension than dim get 0.0
+   void cosine_block(const vector<embrow_t>& s1rows, const vector<embrow_t>& hyprows,
+                     int dim, int mode, vector<double>& out) {
+      vector<int> s1idx(s1rows.size(), -1);
+      vector<int> hypidx(hyprows.size(), -1);
+      vector<const float*> s1data;
+      vector<const float*> hypdata;
+      for (size_t i = 0; i < s1rows.size(); i++) {
+         if (s1rows[i].size() == dim) {
+            s1idx[i] = s1data.size();
+            s1data.push_back(s1rows[i].data_m);
+         }
+      }
+      for (size_t j = 0; j < hyprows.size(); j++) {
+         if (hyprows[j].size() == dim) {
+            hypidx[j] = hypdata.size();
+            hypdata.push_back(hyprows[j].data_m);
+         }
+      }
+      vector<double> dots(s1data.size() * hypdata.size());
+      dot_f32_block(s1data.data(), s1data.size(), hypdata.data(), hypdata.size(), dim, dots.data());
+
+      out.resize(s1rows.size() * hyprows.size());
+      for (size_t i = 0; i < s1rows.size(); i++) {
+         for (size_t j = 0; j < hyprows.size(); j++) {
+            double& sim = out[i * hyprows.size() + j];
+            if (s1idx[i] < 0 || hypidx[j] < 0) {
+               sim = 0.0;
+            } else {
+               sim = cosine(dots[s1idx[i] * hypdata.size() + hypidx[j]],
+                            s1rows[i].len_m, hyprows[j].len_m, mode);
+            }
+         }
+      }
+   }
+
+   // one automaton per thread, reused across words
+   lcs_t& get_lcs() {
+      static thread_local lcs_t lcs;
+      return lcs;
+   }
+
+   void check_lcs_mode(int mode) {
+      if (mode == yisi::INP_MODE) {
+         cerr << "ERROR: longest common subsequence lex sim model is not defined "
+            << "in crosslingual settings. Exiting..." << endl;
+         exit(1);
+      }
+   }
+} // anonymous namespace
+
 double lexsimexact_t::get_sim(string ref, string hyp, int mode) {
    if (mode == yisi::INP_MODE) {
       cerr << "ERROR: exact matching lex sim model is not defined "
@@ -42,38 +178,56 @@ double lexsimexact_t::get_sim(string ref, string hyp, int mode) {
    }
 }
 
-double lexsimlcs_t::get_sim(string ref, string hyp, int mode) {
+double lexsimexact_t::get_sim(tokid_type ref, tokid_type hyp, int mode) {
    if (mode == yisi::INP_MODE) {
-      cerr << "ERROR: longest common subsequence lex sim model is not defined "
-         << "in crosslingual settings. Exiting..." << endl;
+      cerr << "ERROR: exact matching lex sim model is not defined "
+           << "in crosslingual settings. Exiting..." << endl;
       exit(1);
    }
-   double lcs_n = 0.0;
-   size_t ref_n = ref.length();
-   size_t hyp_n = hyp.length();
-   // find the length of the longest common character subsequence
-   for (size_t i = 0; i < ref_n - lcs_n; i++) {
-      // cerr << "Current ref pos: " << i << endl;
-      size_t j;
-      for (j = lcs_n + 1; j <= ref_n - i; j++) {
-         //cerr << "Previous common length: " << lcs_n << endl;
-         //cerr << "Current common length: " << j << endl;
-         auto searching = ref.substr(i, j);
-         //cerr << "Current target: " << searching << endl;
-         auto found = hyp.find(searching);
-         //cerr << "Found position: " << found << endl;
-         if (found == string::npos) {
-            break;
-         }
-      }
-      j = j - 1;
-      if (j > lcs_n) {
-         lcs_n = j;
-      }
+   if (ref == hyp) {
+      return 1.0;
+   } else {
+      return eps_m;
+   }
+}
+
+double lexsimlcs_t::get_sim(const lcs_t& ref, const string& hyp) {
+   // length of the longest common character substring
+   size_t hyp_n;
+   double lcs_n = ref.match(hyp, hyp_n);
+   return (2.0 * lcs_n) / (double)(ref.size() + hyp_n);
+}
+
+double lexsimlcs_t::get_sim(string ref, string hyp, int mode) {
+   check_lcs_mode(mode);
+   lcs_t& lcs = get_lcs();
+   lcs.set_word(ref, utf8_m);
+   return get_sim(lcs, hyp);
+}
+
+double lexsimlcs_t::get_sim(tokid_type ref, tokid_type hyp, int mode) {
+   check_lcs_mode(mode);
+   lcs_t& lcs = get_lcs();
+   lcs.set_word(get_vocab().get_token(ref), utf8_m);
+   return get_sim(lcs, get_vocab().get_token(hyp));
+}
+
+void lexsimlcs_t::get_sims(tokid_type ref, const vector<tokid_type>& hyps, int mode, double* out) {
+   check_lcs_mode(mode);
+   lcs_t& lcs = get_lcs();
+   lcs.set_word(get_vocab().get_token(ref), utf8_m);
+   for (size_t j = 0; j < hyps.size(); j++) {
+      out[j] = get_sim(lcs, get_vocab().get_token(hyps[j]));
+   }
+}
+
+bool lexsimlcs_t::get_sims(const vector<tokid_type>& s1, const vector<tokid_type>& hyp,
+                           int mode, vector<double>& out) {
+   out.resize(s1.size() * hyp.size());
+   for (size_t i = 0; i < s1.size(); i++) {
+      get_sims(s1[i], hyp, mode, out.data() + i * hyp.size());
    }
-   //cerr << "lcs of (" << ref << " , " << hyp << ") = ("
-   //     << lcs_n << "," << ref_n << "," << hyp_n << ")" << endl;
-   return (2.0 * lcs_n) / (double)(ref_n + hyp_n);
+   return true;
 }
 
 //lexsimibm_t::lexsimibm_t(string path) {
@@ -131,20 +285,14 @@ double lexsimlcs_t::get_sim(string ref, string hyp, int mode) {
 //   return (pfge + pegf) / 2.0; //TODO: really? should it be GM instead of AM?
 //}
 
-lexsimw2v_t::lexsimw2v_t(string path) {
-   if (path.substr(path.size() - 3) == "bin") {
-      read_binw2v(path, outembeddings_m, dimension_m);
-   } else {
-      read_txtw2v(path, outembeddings_m, dimension_m);
-   }
-   if (outembeddings_m.find("<unk>") == outembeddings_m.end()) {
-      vector<double> unk;
-      //for (int i = 0; i < dimension_m; i++) {
-      //   unk.push_back(eps_m);
-      //}
-      outembeddings_m["<unk>"] = unk;
-   }
+lexsimw2v_t::lexsimw2v_t(string path, const wordset_type* outvocab) {
+   read_outw2v(path, outvocab);
+}
+
+void lexsimw2v_t::read_outw2v(string path, const wordset_type* outvocab) {
+   read_w2v(path, outembeddings_m, dimension_m, outvocab);
    func_m = "cosine";
+   simfunc_m = get_simfunc(func_m);
 }
 
 //lexsimw2v_t::lexsimw2v_t(string path, string func) {
@@ -160,13 +308,17 @@ lexsimw2v_t::lexsimw2v_t(string path) {
 //   func_m = func;
 //}
 
-vector<double>& lexsimw2v_t::get_wv(string word, int mode) {
+vector<double> lexsimw2v_t::get_wv(string word, int mode) {
+   return this->get_row(word, mode).get_vector();
+}
+
+embrow_t lexsimw2v_t::get_row(string word, int mode) {
    if (mode == yisi::INP_MODE) {
       cerr << "ERROR: w2v lex sim model is not defined "
            << "in crosslingual settings. Exiting..." << endl;
       exit(1);
    }
-   return yisi::get_wv(outembeddings_m, word);
+   return outembeddings_m.get_wv(word);
 }
 
 double lexsimw2v_t::get_sim(string ref, string hyp, int mode) {
@@ -178,13 +330,82 @@ double lexsimw2v_t::get_sim(string ref, string hyp, int mode) {
    if (lowercase(ref) == lowercase(hyp)) {
       return 1.0;
    } else {
-      return this->get_sim(this->get_wv(ref, mode), this->get_wv(hyp, yisi::HYP_MODE));
+      return this->get_sim(this->get_row(ref, mode), this->get_row(hyp, yisi::HYP_MODE));
+   }
+}
+
+embrow_t lexsimw2v_t::get_row(tokid_type id, int mode) {
+   int side = (mode == yisi::INP_MODE) ? 0 : 1;
+   if (id < idrow_m[side].size()) {
+      return idrow_m[side][id];
+   }
+   // tokens interned after prepare() are looked up directly
+   return this->get_row(get_vocab().get_token(id), mode);
+}
+
+void lexsimw2v_t::prepare(bool inp) {
+   size_t n = get_vocab().size();
+   for (int side = inp ? 0 : 1; side < 2; side++) {
+      int mode = (side == 0) ? yisi::INP_MODE : yisi::REF_MODE;
+      for (tokid_type id = idrow_m[side].size(); id < n; id++) {
+         idrow_m[side].push_back(this->get_row(get_vocab().get_token(id), mode));
+      }
+   }
+}
+
+bool lexsimw2v_t::same_token(tokid_type ref, tokid_type hyp, int mode) {
+   if (mode == yisi::INP_MODE) {
+      cerr << "ERROR: w2v lex sim model is not defined "
+           << "in crosslingual settings. Exiting..." << endl;
+      exit(1);
+   }
+   return get_vocab().get_lcid(ref) == get_vocab().get_lcid(hyp);
+}
+
+double lexsimw2v_t::get_sim(tokid_type ref, tokid_type hyp, int mode) {
+   if (same_token(ref, hyp, mode)) {
+      return 1.0;
+   } else {
+      return this->get_sim(get_row(ref, mode), get_row(hyp, yisi::HYP_MODE));
+   }
+}
+
+bool lexsimw2v_t::get_sims(const vector<tokid_type>& s1, const vector<tokid_type>& hyp,
+                           int mode, vector<double>& out) {
+   int cmode = get_cosine_mode(simfunc_m);
+   if (cmode < 0) {
+      return false;
+   }
+   vector<embrow_t> s1rows;
+   vector<embrow_t> hyprows;
+   for (size_t i = 0; i < s1.size(); i++) {
+      s1rows.push_back(get_row(s1[i], mode));
+   }
+   for (size_t j = 0; j < hyp.size(); j++) {
+      hyprows.push_back(get_row(hyp[j], yisi::HYP_MODE));
+   }
+   cosine_block(s1rows, hyprows, dimension_m, cmode, out);
+   for (size_t i = 0; i < s1.size(); i++) {
+      for (size_t j = 0; j < hyp.size(); j++) {
+         if (same_token(s1[i], hyp[j], mode)) {
+            out[i * hyp.size() + j] = 1.0;
+         }
+      }
    }
+   return true;
 }
 
-double lexsimw2v_t::get_sim(vector<double>& ref, vector<double>& hyp) {
+double lexsimw2v_t::get_sim(const vecview_t& ref, const vecview_t& hyp) {
    if ((int)ref.size() == dimension_m && (int)hyp.size() == dimension_m) {
-      return yisi::get_sim(ref, hyp, func_m);
+      return yisi::simfunc(simfunc_m, ref, hyp);
+   } else {
+      return 0.0;
+   }
+}
+
+double lexsimw2v_t::get_sim(const embrow_t& ref, const embrow_t& hyp) {
+   if (ref.size() == dimension_m && hyp.size() == dimension_m) {
+      return yisi::simfunc(simfunc_m, ref, hyp);
    } else {
       return 0.0;
    }
@@ -197,25 +418,38 @@ void lexsimw2v_t::write_txtw2v(std::string path) {
    if (!os) {
       cerr << "ERROR: Failed to open file to write w2v model. No model written." << endl;
    } else {
-      os << outembeddings_m.size() - 1 << " " << dimension_m << endl;
-      for (auto it = outembeddings_m.begin(); it != outembeddings_m.end(); it++) {
-         if (it->first != "<unk>") {
-            os << it->first;
-            auto ds = it->second;
-            for (auto jt = ds.begin(); jt != ds.end(); jt++) {
-               os << " " << *jt;
-            }
-            os << endl;
+      // same order and content as the former map-based model
+      vector<pair<string, size_t> > words;
+      for (size_t i = 0; i < outembeddings_m.size(); i++) {
+         auto w = outembeddings_m.get_word(i);
+         if (w != "<unk>") {
+            words.push_back(make_pair(w, i));
          }
       }
+      sort(words.begin(), words.end());
+      os << words.size() << " " << dimension_m << endl;
+      for (auto it = words.begin(); it != words.end(); it++) {
+         os << it->first;
+         auto ds = outembeddings_m.get_row(it->second);
+         for (int j = 0; j < ds.size(); j++) {
+            os << " " << ds[j];
+         }
+         os << endl;
+      }
    }
 
    os.close();
    cerr << "Done." << endl;
 }
 
-lexsimemapw2v_t::lexsimemapw2v_t(string emap_path, string outw2v_path) :
-   lexsimw2v_t(outw2v_path) {
+void lexsimw2v_t::write_mmw2v(std::string path) {
+   cerr << "Writing w2v model in mmw2v format to file " << path << " ...";
+   outembeddings_m.write_mmw2v(path);
+   cerr << "Done." << endl;
+}
+
+lexsimemapw2v_t::lexsimemapw2v_t(string emap_path, string outw2v_path,
+                                 const wordset_type* inpvocab, const wordset_type* outvocab) {
    cerr << "Reading emap model from " << emap_path << endl;
    ifstream EMAP(emap_path.c_str());
    if (!EMAP) {
@@ -230,9 +464,26 @@ lexsimemapw2v_t::lexsimemapw2v_t(string emap_path, string outw2v_path) :
    }
    EMAP.close();
    cerr << "Finished reading." << endl;
+
+   // input words are looked up in the output model through the emap, or as
+   // they are when they have no entry, so both vocabularies are needed to filter
+   if (inpvocab != NULL && outvocab != NULL) {
+      wordset_type vocab(*outvocab);
+      vocab.insert(inpvocab->begin(), inpvocab->end());
+      for (auto it = inpvocab->begin(); it != inpvocab->end(); it++) {
+         auto jt = emap_m.find(*it);
+         if (jt != emap_m.end()) {
+            vocab.insert(jt->second);
+            vocab.insert(lowercase(jt->second));
+         }
+      }
+      read_outw2v(outw2v_path, &vocab);
+   } else {
+      read_outw2v(outw2v_path, NULL);
+   }
 }
 
-vector<double>& lexsimemapw2v_t::get_wv(string word, int mode) {
+embrow_t lexsimemapw2v_t::get_row(string word, int mode) {
    if (mode == yisi::INP_MODE) {
       if (emap_m.find(word) != emap_m.end()) {
          word = emap_m[word];
@@ -240,71 +491,62 @@ vector<double>& lexsimemapw2v_t::get_wv(string word, int mode) {
          word = emap_m[lowercase(word)];
       }
    }
-   return yisi::get_wv(outembeddings_m, word);
+   return outembeddings_m.get_wv(word);
 }
 
 double lexsimemapw2v_t::get_sim(string s1, string hyp, int mode) {
    if (lowercase(s1) == lowercase(hyp)) {
       return 1.0;
    } else {
-      double result = this->get_sim(this->get_wv(s1, mode), this->get_wv(hyp, yisi::HYP_MODE));
+      double result = this->get_sim(this->get_row(s1, mode), this->get_row(hyp, yisi::HYP_MODE));
       //cerr << "(" << s1 << "," << hyp << "," << mode << "," << result << ")" << endl;
       return result;
    }
 }
 
-double lexsimemapw2v_t::get_sim(vector<double>& s1, vector<double>& hyp) {
-   if ((int)s1.size() == dimension_m && (int)hyp.size() == dimension_m) {
-      return yisi::get_sim(s1, hyp, func_m);
-   } else {
-      return 0.0;
-   }
+bool lexsimemapw2v_t::same_token(tokid_type s1, tokid_type hyp, int mode) {
+   return get_vocab().get_lcid(s1) == get_vocab().get_lcid(hyp);
 }
 
-lexsimbiw2v_t::lexsimbiw2v_t(string inpw2v_path, string outw2v_path)
-: lexsimw2v_t(outw2v_path) {
-   if (inpw2v_path.substr(inpw2v_path.size() - 3) == "bin") {
-      read_binw2v(inpw2v_path, inpembeddings_m, dimension_m);
-   } else {
-      read_txtw2v(inpw2v_path, inpembeddings_m, dimension_m);
-   }
-   if (inpembeddings_m.find("<unk>") == inpembeddings_m.end()) {
-      vector<double> unk;
-      //for (int i = 0; i < dimension_m; i++) {
-      //   unk.push_back(eps_m);
-      //}
-      inpembeddings_m["<unk>"] = unk;
-   }
+lexsimbiw2v_t::lexsimbiw2v_t(string inpw2v_path, string outw2v_path,
+                             const wordset_type* inpvocab, const wordset_type* outvocab)
+: lexsimw2v_t(outw2v_path, outvocab) {
+   read_w2v(inpw2v_path, inpembeddings_m, dimension_m, inpvocab);
 }
 
-vector<double>& lexsimbiw2v_t::get_wv(string word, int mode) {
+embrow_t lexsimbiw2v_t::get_row(string word, int mode) {
    if (mode == yisi::INP_MODE) {
-      return yisi::get_wv(inpembeddings_m, word);
+      return inpembeddings_m.get_wv(word);
    } else {
-      return yisi::get_wv(outembeddings_m, word);
+      return outembeddings_m.get_wv(word);
    }
 }
 
+bool lexsimbiw2v_t::has_wv(const embtable_t& model, string word) {
+   // <unk> always had an entry in the former map-based models
+   return word == "<unk>" || model.find(word) >= 0;
+}
+
 double lexsimbiw2v_t::get_sim(string s1, string hyp, int mode) {
    if ((lowercase(s1) == lowercase(hyp))
       && (((mode == yisi::INP_MODE)
-         && ((inpembeddings_m.find(s1) == inpembeddings_m.end())
-            || outembeddings_m.find(hyp) == outembeddings_m.end()))
+         && (!has_wv(inpembeddings_m, s1) || !has_wv(outembeddings_m, hyp)))
          || (mode != yisi::INP_MODE))) {
       return 1.0;
    } else {
-      double result = this->get_sim(this->get_wv(s1, mode), this->get_wv(hyp, yisi::HYP_MODE));
+      double result = this->get_sim(this->get_row(s1, mode), this->get_row(hyp, yisi::HYP_MODE));
       //cerr << "(" << s1 << "," << hyp << "," << mode << "," << result << ")" << endl;
       return result;
    }
 }
 
-double lexsimbiw2v_t::get_sim(vector<double>& s1, vector<double>& hyp) {
-   if ((int)s1.size() == dimension_m && (int)hyp.size() == dimension_m) {
-      return yisi::get_sim(s1, hyp, func_m);
-   } else {
-      return 0.0;
-   }
+bool lexsimbiw2v_t::same_token(tokid_type s1, tokid_type hyp, int mode) {
+   const vocab_t& vocab = get_vocab();
+   return (vocab.get_lcid(s1) == vocab.get_lcid(hyp))
+      && (((mode == yisi::INP_MODE)
+         && (!has_wv(inpembeddings_m, vocab.get_token(s1))
+            || !has_wv(outembeddings_m, vocab.get_token(hyp))))
+         || (mode != yisi::INP_MODE));
 }
 
 double lexsimemb_t::get_sim(string s1, string hyp, int mode){
@@ -312,27 +554,82 @@ double lexsimemb_t::get_sim(string s1, string hyp, int mode){
   exit(1);
 }
 
-double lexsimemb_t::get_sim(vector<double>& s1, vector<double>& hyp){
-  return yisi::get_sim(s1, hyp, func_m);
+double lexsimemb_t::get_sim(const vecview_t& s1, const vecview_t& hyp){
+  return yisi::simfunc(simfunc_m, s1, hyp);
+}
+
+double lexsimemb_t::get_sim(const embrow_t& s1, const embrow_t& hyp) {
+   return yisi::simfunc(simfunc_m, s1, hyp);
+}
+
+bool lexsimemb_t::get_sims(const matview_t& s1, const matview_t& hyp, vector<double>& out) {
+   int cmode = get_cosine_mode(simfunc_m);
+   if (cmode < 0 || s1.size() == 0) {
+      return false;
+   }
+   // units of another dimension than the first one are left to the pairwise path
+   int dim = s1[0].size();
+   vector<embrow_t> s1rows;
+   vector<embrow_t> hyprows;
+   for (size_t i = 0; i < s1.size(); i++) {
+      s1rows.push_back(s1[i]);
+      if (s1rows.back().size() != dim) {
+         return false;
+      }
+   }
+   for (size_t j = 0; j < hyp.size(); j++) {
+      hyprows.push_back(hyp[j]);
+      if (hyprows.back().size() != dim) {
+         return false;
+      }
+   }
+   cosine_block(s1rows, hyprows, dim, cmode, out);
+   return true;
 }
 
 lexsim_t::lexsim_t() {
    lexsim_p = new lexsimexact_t();
+   lexsim_name_m = "exact";
+}
+
+lexsim_t::lexsim_t(string name, string out_path, string inp_path,
+                   string outvocab_path, string inpvocab_path) {
+   init(name, out_path, inp_path, outvocab_path, inpvocab_path);
+}
+
+lexsim_t::lexsim_t(lexsim_t& rhs) {
+   init(rhs.lexsim_name_m, rhs.outlexsim_path_m, rhs.inplexsim_path_m,
+        rhs.outvocab_path_m, rhs.inpvocab_path_m);
 }
 
-lexsim_t::lexsim_t(string name, string out_path, string inp_path) {
+void lexsim_t::init(string name, string out_path, string inp_path,
+                    string outvocab_path, string inpvocab_path) {
+   wordset_type outvocab;
+   wordset_type inpvocab;
+   if (outvocab_path != "") {
+      outvocab = read_wordset(outvocab_path);
+   }
+   if (inpvocab_path != "") {
+      inpvocab = read_wordset(inpvocab_path);
+   }
+   const wordset_type* outvocab_p = (outvocab_path != "") ? &outvocab : NULL;
+   const wordset_type* inpvocab_p = (inpvocab_path != "") ? &inpvocab : NULL;
+
+   lexsim_p = NULL;
    if (name == "exact") {
       lexsim_p = new lexsimexact_t();
    } else if (name == "ibm") {
      //lexsim_p = new lexsimibm_t(path);
    } else if (name == "w2v") {
-     lexsim_p = new lexsimw2v_t(out_path);
+     lexsim_p = new lexsimw2v_t(out_path, outvocab_p);
    } else if (name == "ibmw2v" || name == "emapw2v") {
-     lexsim_p = new lexsimemapw2v_t(inp_path, out_path);
+     lexsim_p = new lexsimemapw2v_t(inp_path, out_path, inpvocab_p, outvocab_p);
    } else if (name == "biw2v") {
-     lexsim_p = new lexsimbiw2v_t(inp_path, out_path);
+     lexsim_p = new lexsimbiw2v_t(inp_path, out_path, inpvocab_p, outvocab_p);
    } else if (name == "lcs") {
      lexsim_p = new lexsimlcs_t();
+   } else if (name == "lcsutf8") {
+     lexsim_p = new lexsimlcs_t(true);
    } else if (name == "emb"){
      lexsim_p = new lexsimemb_t();
    } else {
@@ -341,27 +638,14 @@ lexsim_t::lexsim_t(string name, string out_path, string inp_path) {
    lexsim_name_m = name;
    outlexsim_path_m = out_path;
    inplexsim_path_m = inp_path;
+   outvocab_path_m = outvocab_path;
+   inpvocab_path_m = inpvocab_path;
 }
 
-lexsim_t::lexsim_t(lexsim_t& rhs) {
-   if (rhs.lexsim_name_m == "exact") {
-      lexsim_p = new lexsimexact_t();
-   } else if (rhs.lexsim_name_m == "ibm") {
-      //lexsim_p = new lexsimibm_t(rhs.lexsim_path_m);
-   } else if (rhs.lexsim_name_m == "w2v") {
-      lexsim_p = new lexsimw2v_t(rhs.outlexsim_path_m);
-   } else if (rhs.lexsim_name_m == "ibmw2v" || rhs.lexsim_name_m == "emapw2v") {
-     lexsim_p = new lexsimemapw2v_t(rhs.inplexsim_path_m, rhs.outlexsim_path_m);
-   } else if (rhs.lexsim_name_m == "biw2v") {
-      lexsim_p = new lexsimbiw2v_t(rhs.inplexsim_path_m, rhs.outlexsim_path_m);
-   } else if (rhs.lexsim_name_m == "lcs") {
-      lexsim_p = new lexsimlcs_t();
-   } else if (rhs.lexsim_name_m == "emb") {
-     lexsim_p = new lexsimemb_t();
-   }
-   lexsim_name_m = rhs.lexsim_name_m;
-   outlexsim_path_m = rhs.outlexsim_path_m;
-   inplexsim_path_m = rhs.inplexsim_path_m;
+string lexsim_t::get_fingerprint() {
+   // the vocabulary filters are left out: they never change a similarity
+   return "lexsim\t" + lexsim_name_m + "\t" + outlexsim_path_m + get_file_stamp(outlexsim_path_m)
+      + "\t" + inplexsim_path_m + get_file_stamp(inplexsim_path_m);
 }
 
 lexsim_t::~lexsim_t() {
@@ -371,48 +655,70 @@ lexsim_t::~lexsim_t() {
 }
 
 double lexsim_t::get_sim(string s1, string hyp, int mode) {
-   //cerr << "Querying " << mode << " lex sim of " << s1 << " and " << hyp << "; ";
-   if (mode == yisi::INP_MODE) {
-      if (xlscache_m.find(s1) != xlscache_m.end()) {
-         if (xlscache_m[s1].find(hyp) != xlscache_m[s1].end()) {
-            auto s = xlscache_m[s1][hyp];
-            return s;
-         }
-      } else {
-         map<string, double> c;
-         xlscache_m[s1] = c;
-      }
-   } else {
-      if (mlscache_m.find(s1) != mlscache_m.end()) {
-         if (mlscache_m[s1].find(hyp) != mlscache_m[s1].end()) {
-            auto s = mlscache_m[s1][hyp];
-            //cerr << "find in cache = " << s << endl;
-            return s;
-         }
-      } else {
-         map<string, double> c;
-         mlscache_m[s1] = c;
+   // tokens never interned are compared as strings rather than interned, so
+   // that this is safe while other threads read the vocabulary
+   const vocab_t& vocab = get_vocab();
+   tokid_type s1id = vocab.lookup(s1);
+   tokid_type hypid = vocab.lookup(hyp);
+   if (s1id == UNKNOWN_TOKID || hypid == UNKNOWN_TOKID) {
+      return lexsim_p->get_sim(s1, hyp, mode);
+   }
+   return get_sim(s1id, hypid, mode);
+}
+
+double lexsim_t::get_sim(tokid_type s1, tokid_type hyp, int mode) {
+   return lexsim_p->get_sim(s1, hyp, mode);
+}
+
+void lexsim_t::get_sims(const vector<tokid_type>& s1, const vector<tokid_type>& hyp,
+                        int mode, vector<double>& out) {
+   if (lexsim_p->get_sims(s1, hyp, mode, out)) {
+      return;
+   }
+   out.resize(s1.size() * hyp.size());
+   for (size_t i = 0; i < s1.size(); i++) {
+      for (size_t j = 0; j < hyp.size(); j++) {
+         out[i * hyp.size() + j] = lexsim_p->get_sim(s1[i], hyp[j], mode);
       }
    }
-   //cerr << "computing = ";
-   double s = lexsim_p->get_sim(s1, hyp, mode);
-   if (mode == yisi::INP_MODE) {
-      xlscache_m[s1][hyp] = s;
-   } else {
-      mlscache_m[s1][hyp] = s;
-      //cerr<<s << endl;
+}
+
+double lexsim_t::get_sim(const embrow_t& v1, const embrow_t& hyp) {
+   return lexsim_p->get_sim(v1, hyp);
+}
+
+void lexsim_t::get_sims(const matview_t& s1, const matview_t& hyp, vector<double>& out) {
+   if (lexsim_p->get_sims(s1, hyp, out)) {
+      return;
+   }
+   out.resize(s1.size() * hyp.size());
+   for (size_t i = 0; i < s1.size(); i++) {
+      for (size_t j = 0; j < hyp.size(); j++) {
+         out[i * hyp.size() + j] = lexsim_p->get_sim(s1[i], hyp[j]);
+      }
    }
-   return s;
 }
 
-double lexsim_t::get_sim(vector<double>& v1, vector<double>& hyp) {
+double lexsim_t::get_sim(const vecview_t& v1, const vecview_t& hyp) {
    return lexsim_p->get_sim(v1, hyp);
 }
 
-vector<double>& lexsim_t::get_wv(string word, int mode) {
+vector<double> lexsim_t::get_wv(string word, int mode) {
    return lexsim_p->get_wv(word, mode);
 }
-void yisi::read_binw2v(string path, map<string, vector<double> >& model, int& dimension) {
+
+void yisi::read_w2v(string path, embtable_t& model, int& dimension, const wordset_type* filter) {
+   if (path.size() >= 5 && path.substr(path.size() - 5) == "mmw2v") {
+      // pages of a mapped model are only loaded when used; no need to filter
+      read_mmw2v(path, model, dimension);
+   } else if (path.substr(path.size() - 3) == "bin") {
+      read_binw2v(path, model, dimension, filter);
+   } else {
+      read_txtw2v(path, model, dimension, filter);
+   }
+}
+
+void yisi::read_binw2v(string path, embtable_t& model, int& dimension, const wordset_type* filter) {
    long long n = 0;
    long long d = 0;
    char tmp;
@@ -429,100 +735,185 @@ void yisi::read_binw2v(string path, map<string, vector<double> >& model, int& di
    dimension = (int)d;
    cerr << "Size of voc: " << n << " Dimension: " << dimension << endl;
    W2V.get(tmp);
+   model.init(dimension);
+   vector<float> embedding(dimension);
    for (long long i = 0; i < n; i++) {
       string wordtmp;
       getline(W2V, wordtmp, ' ');
       string word = strip(wordtmp);
       //cerr << i << "\t" << word << endl;
-      vector<double> embedding;
+      if (filter != NULL && filter->find(word) == filter->end()) {
+         W2V.ignore(dimension * sizeof(float));
+         continue;
+      }
       double len = 0.0;
       for (long long j = 0; j < dimension; j++) {
          float f;
          W2V.read((char*)&f, sizeof(float));
          //cerr << "\t" << j << " " << f << endl;
-         embedding.push_back(f);
+         embedding[j] = f;
          len += f * f;
       }
       len = sqrt(len);
       //cerr << len << endl;
-      for (long long j = 0; j < dimension; j++) {
-         embedding[j] /= len;
-      }
-
-      model[word] = embedding;
+      model.add(word, embedding.data(), len);
       //getline(W2V, word, '\n');
    }
+   model.finalize();
 
+   if (filter != NULL) {
+      cerr << "Kept " << model.size() << " word vectors found in the vocabulary filter." << endl;
+   }
    cerr << "Finished reading w2v model. Embedding size is " << model.size() << endl;
 
    W2V.close();
 }
 
-void yisi::read_txtw2v(string path, map<string, vector<double> >& model, int& dimension) {
-   unsigned int n = 0;
-   unsigned int d = 0;
-   char tmp;
-
+void yisi::read_txtw2v(string path, embtable_t& model, int& dimension, const wordset_type* filter) {
    cerr << "Reading w2v text model from " << path << endl;
-   ifstream W2V(path.c_str());
-   if (!W2V) {
+   int fd = open(path.c_str(), O_RDONLY);
+   struct stat st;
+   if (fd < 0 || fstat(fd, &st) != 0) {
       cerr << "ERROR: Failed to open w2v model. Exiting..." << endl;
       exit(1);
    }
+   size_t size = st.st_size;
+   void* map_p = NULL;
+   if (size > 0) {
+      map_p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map_p == MAP_FAILED) {
+         cerr << "ERROR: Failed to read w2v model. Exiting..." << endl;
+         exit(1);
+      }
+      madvise(map_p, size, MADV_SEQUENTIAL);
+   }
+   close(fd);
+   const char* data = (const char*)map_p;
+   const char* end = data + size;
 
-   W2V >> n;
-   W2V >> d;
+   // header: as W2V >> n >> d, then one separator character
+   unsigned int n = 0;
+   unsigned int d = 0;
+   // the header line is taken with its newline so that tellg stays valid
+   string header(data, min(end, find(data, end, '\n') + 1) - data);
+   istringstream HEADER(header);
+   HEADER >> n >> d;
+   const char* body = data + min(size, (size_t)HEADER.tellg() + 1);
+   if (HEADER.fail()) {
+      body = end;
+   }
    dimension = (int)d;
    cerr << "Size of voc: " << n << " Dimension: " << dimension << endl;
-   W2V.get(tmp);
-   for (unsigned int i = 0; i < n; i++) {
-      string word;
-      getline(W2V, word, ' ');
-      //cout << i << ": [" << word << ", ";
-      vector<double> embedding;
-      double len = 0.0;
-      string af;
-      float f;
-      for (int j = 0; j < dimension - 1; j++) {
-         getline(W2V, af, ' ');
-         f = atof(af.c_str());
-         //cout << f << ", ";
-         embedding.push_back(f);
-         len += f * f;
+   model.init(dimension);
+
+   // a last line without its newline is parsed from a copy, so that strtod
+   // always finds a delimiter inside the buffer
+   string lastline;
+   if (body < end && *(end - 1) != '\n') {
+      const char* p = end;
+      while (p > body && *(p - 1) != '\n') {
+         p--;
       }
-      getline(W2V, af);
-      f = atof(af.c_str());
-      //cout << f << "]" << endl;
-      embedding.push_back(f);
+      lastline.assign(p, end - p);
+      end = p;
+   }
 
-      len += f * f;
+   // split the body into chunks at line boundaries
+   size_t nthreads = max(1u, thread::hardware_concurrency());
+   nthreads = max((size_t)1, min(nthreads, (size_t)(end - body) / (1 << 20)));
+   vector<const char*> bounds(nthreads + 1, end);
+   bounds[0] = body;
+   for (size_t k = 1; k < nthreads; k++) {
+      const char* p = max(bounds[k - 1], body + (end - body) / nthreads * k);
+      p = find(p, end, '\n');
+      bounds[k] = (p < end) ? p + 1 : end;
+   }
 
-      len = sqrt(len);
-      //cerr << len << endl;
-      for (int j = 0; j < dimension; j++) {
-         embedding[j] /= len;
+   // first pass: the word of every line, and whether it is kept
+   vector<vector<txtw2v_line_t> > lines(nthreads + 1);
+   vector<size_t> nlines(nthreads + 1, 0);
+   run_parallel(nthreads, [&](size_t k) {
+      for (const char* p = bounds[k]; p < bounds[k + 1]; ) {
+         const char* eol = find(p, bounds[k + 1], '\n');
+         lines[k].push_back(make_txtw2v_line(p, eol));
+         nlines[k]++;
+         p = eol + 1;
+      }
+   });
+   if (!lastline.empty()) {
+      lines[nthreads].push_back(make_txtw2v_line(lastline.data(), lastline.data() + lastline.size()));
+      nlines[nthreads] = 1;
+   }
+
+   // only the first n lines are entries; allocate the kept rows in file order
+   vector<size_t> firstrow(nthreads + 1, 0);
+   size_t lineid = 0;
+   for (size_t k = 0; k <= nthreads; k++) {
+      if (lineid + lines[k].size() > n) {
+         lines[k].resize(lineid < n ? n - lineid : 0);
+      }
+      lineid += nlines[k];
+      vector<string> words;
+      vector<txtw2v_line_t> kept;
+      for (auto it = lines[k].begin(); it != lines[k].end(); it++) {
+         if (filter == NULL || filter->find(it->word_m) != filter->end()) {
+            words.push_back(it->word_m);
+            kept.push_back(*it);
+         }
+      }
+      lines[k].swap(kept);
+      firstrow[k] = model.add_rows(words);
+   }
+
+   // second pass: parse and measure the kept rows
+   run_parallel(nthreads + 1, [&](size_t k) {
+      for (size_t i = 0; i < lines[k].size(); i++) {
+         float* row = model.get_data(firstrow[k] + i);
+         model.set_len(firstrow[k] + i, parse_txtw2v_row(lines[k][i], dimension, row));
       }
+   });
 
-      model[word] = embedding;
+   model.finalize();
+   if (map_p != NULL) {
+      munmap(map_p, size);
+   }
+   if (filter != NULL) {
+      cerr << "Kept " << model.size() << " word vectors found in the vocabulary filter." << endl;
    }
    cerr << "Finished reading w2v model." << endl;
-   W2V.close();
 }
 
-vector<double>& yisi::get_wv(map<string, vector<double> >& model, string word) {
-   if (model.find(word) != model.end()) {
-      return model[word];
-   } else {
-      string l = lowercase(word);
-      if (model.find(l) != model.end()) {
-         return model[l];
-      } else {
-         return model["<unk>"];
+void yisi::read_mmw2v(string path, embtable_t& model, int& dimension) {
+   cerr << "Reading w2v mmap model from " << path << endl;
+   model.map_file(path);
+   dimension = model.get_dimension();
+   cerr << "Size of voc: " << model.size() << " Dimension: " << dimension << endl;
+   cerr << "Finished reading w2v model." << endl;
+}
+
+wordset_type yisi::read_wordset(string paths) {
+   // every token of the files, with its lowercased form as get_wv falls back to it
+   wordset_type result;
+   auto files = tokenize(paths, ':');
+   for (auto it = files.begin(); it != files.end(); it++) {
+      auto lines = read_file(*it);
+      for (auto jt = lines.begin(); jt != lines.end(); jt++) {
+         auto tokens = tokenize(*jt);
+         for (auto kt = tokens.begin(); kt != tokens.end(); kt++) {
+            result.insert(*kt);
+            result.insert(lowercase(*kt));
+         }
       }
    }
+   result.insert("<unk>");
+   return result;
 }
 
-double yisi::get_sim(vector<double>& v1, vector<double>& v2, string func) {
+double yisi::get_sim(const vecview_t& v1, const vecview_t& v2, string func) {
+   return simfunc(func, v1, v2);
+}
+
+double yisi::get_sim(const embrow_t& v1, const embrow_t& v2, string func) {
    return simfunc(func, v1, v2);
 }
 
@@ -530,24 +921,45 @@ bool yisi::sort_helper(pair<string, double> i, pair<string, double> j) {
    return i.second > j.second;
 }
 
-double yisi::simfunc(string funcname, vector<double>& ref, vector<double>& hyp) {
-   if (funcname == "ucosine") {
+double yisi::simfunc(string funcname, const vecview_t& ref, const vecview_t& hyp) {
+   return simfunc(get_simfunc(funcname), ref, hyp);
+}
+
+double yisi::simfunc(string funcname, const embrow_t& ref, const embrow_t& hyp) {
+   return simfunc(get_simfunc(funcname), ref, hyp);
+}
+
+double yisi::simfunc(simfunc_type func, const vecview_t& ref, const vecview_t& hyp) {
+   switch (func) {
+   case UCOSINE_FUNC:
       return cosine(ref, hyp, 0);
-   } else if (funcname == "cosine") {
+   case COSINE_FUNC:
       return cosine(ref, hyp, 1);
-   } else if (funcname == "tcosine") {
+   case TCOSINE_FUNC:
       return cosine(ref, hyp, 2);
-   } else if (funcname == "jaccard") {
+   case JACCARD_FUNC:
       return jaccard(ref, hyp, 0);
-   } else if (funcname == "mjaccard") {
+   default:
       return jaccard(ref, hyp, 1);
-   } else {
-      cerr << "ERROR: Unknown lexsim function " << funcname << endl;
-      exit(1);
    }
 }
 
-double yisi::cosine(vector<double>& ref, vector<double>& hyp, int mode) {
+double yisi::simfunc(simfunc_type func, const embrow_t& ref, const embrow_t& hyp) {
+   switch (func) {
+   case UCOSINE_FUNC:
+      return cosine(ref, hyp, 0);
+   case COSINE_FUNC:
+      return cosine(ref, hyp, 1);
+   case TCOSINE_FUNC:
+      return cosine(ref, hyp, 2);
+   case JACCARD_FUNC:
+      return jaccard(ref, hyp, 0);
+   default:
+      return jaccard(ref, hyp, 1);
+   }
+}
+
+double yisi::cosine(const vecview_t& ref, const vecview_t& hyp, int mode) {
    // grounded cosine similarity mapping all resulted values ranged from [-1,0) to 0
    double sim = 0.0;
 
@@ -574,7 +986,7 @@ double yisi::cosine(vector<double>& ref, vector<double>& hyp, int mode) {
 }
 
 
-double yisi::jaccard(vector<double>& ref, vector<double>& hyp, int mode) {
+double yisi::jaccard(const vecview_t& ref, const vecview_t& hyp, int mode) {
    double min = 0.0;
    double max = 0.0;
 
@@ -601,3 +1013,36 @@ double yisi::jaccard(vector<double>& ref, vector<double>& hyp, int mode) {
    }
    return min / max;
 }
+
+double yisi::cosine(const embrow_t& ref, const embrow_t& hyp, int mode) {
+   double sim = 0.0;
+
+   if (ref.size() != hyp.size()) {
+      return sim;
+   }
+   // the components are only normalized once, on the dot product
+   return cosine(dot_f32(ref.data_m, hyp.data_m, ref.size()), ref.len_m, hyp.len_m, mode);
+}
+
+double yisi::cosine(double dot, double reflen, double hyplen, int mode) {
+   double sim = dot / (reflen * hyplen);
+   if (mode == 0) {
+      return sim;
+   } else if (mode == 1) {
+      if (sim > 0.0) {
+         return sim;
+      } else {
+         return 0.0;
+      }
+   } else {
+      return sim * 0.5 + 0.5;
+   }
+}
+
+double yisi::jaccard(const embrow_t& ref, const embrow_t& hyp, int mode) {
+   double min = 0.0;
+   double max = 0.0;
+
+   minmax_f32(ref.data_m, ref.len_m, hyp.data_m, hyp.len_m, ref.size(), mode, min, max);
+   return min / max;
+}
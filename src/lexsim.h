@@ -8,6 +8,7 @@
  *    - lexsim_t (wrapper class)
  *    - lexsimmodel_t (abstract base class of different lex sim models)
  *    - lexsimexact_t (simiple exact match lex sim model)
+ *    - lexsimlcs_t (longest common substring lex sim model)
  *    - lexsimibm_t (ibm1 lex sim model: crosslingual) ***deprecated: performance not as good as biw2v*** 
  *    - lexsimw2v_t (w2v lex sim model)
  *    - lexsimemapw2v_t (emapw2v lex sim model: crosslingual)
@@ -26,6 +27,12 @@
 #define LEXSIM_H
 
 #include "util.h"
+#include "embtable.h"
+#include "embview.h"
+#include "lcs.h"
+#include "simcache.h"
+#include "vecsim.h"
+#include "vocab.h"
 
 #include <utility>
 #include <string>
@@ -35,26 +42,47 @@
 
 namespace yisi {
 
-   static std::map<std::string, std::map<std::string, double> > mlscache_m;
-   static std::map<std::string, std::map<std::string, double> > xlscache_m;
-
    class lexsimmodel_t {
    public:
       lexsimmodel_t() { eps_m=0.00001; }
       virtual ~lexsimmodel_t() {}
-      virtual std::vector<double>& get_wv(std::string word, int mode) {
+      virtual std::vector<double> get_wv(std::string word, int mode) {
          std::cerr << "ERROR: lexsim model is not a word vector model. Exiting..." << std::endl;
          exit(1);
       }
       virtual double get_sim(std::string ref, std::string hyp, int mode)=0;
-      virtual double get_sim(std::vector<double>& ref, std::vector<double>& hyp) {
+      // similarity of interned tokens; models override it to avoid the strings
+      virtual double get_sim(tokid_type ref, tokid_type hyp, int mode) {
+         return get_sim(get_vocab().get_token(ref), get_vocab().get_token(hyp), mode);
+      }
+      virtual double get_sim(const vecview_t& ref, const vecview_t& hyp) {
          std::cerr << "ERROR: lexsim model is not a word vector model" << std::endl;
          return 0.0;
       }
+      virtual double get_sim(const embrow_t& ref, const embrow_t& hyp) {
+         std::cerr << "ERROR: lexsim model is not a word vector model" << std::endl;
+         return 0.0;
+      }
+      // similarities of all the pairs of embeddings at once, as below
+      virtual bool get_sims(const matview_t& s1, const matview_t& hyp, std::vector<double>& out) {
+         return false;
+      }
+      // similarities of all the pairs at once, out[i * hyp.size() + j] for
+      // s1[i] and hyp[j]; false if the model has no batch computation
+      virtual bool get_sims(const std::vector<tokid_type>& s1, const std::vector<tokid_type>& hyp,
+                            int mode, std::vector<double>& out) {
+         return false;
+      }
+      // called once all the sentences are read, before any concurrent scoring
+      virtual void prepare(bool inp) {}
       virtual void write_txtw2v(std::string path) {
          std::cerr << "ERROR: lexsim model is not a word vector model" << std::endl;
          exit(1);
       }
+      virtual void write_mmw2v(std::string path) {
+         std::cerr << "ERROR: lexsim model is not a word vector model" << std::endl;
+         exit(1);
+      }
    protected:
       double eps_m;
    }; // class lexsimmodel_t
@@ -66,17 +94,26 @@ namespace yisi {
       }
       virtual ~lexsimexact_t() {}
       virtual double get_sim(std::string ref, std::string hyp, int mode);
+      virtual double get_sim(tokid_type ref, tokid_type hyp, int mode);
    private:
    }; // class lexsimexact_t
 
    class lexsimlcs_t:public lexsimmodel_t {
    public:
-      lexsimlcs_t() {
+      // utf8: count UTF-8 code points instead of bytes
+      lexsimlcs_t(bool utf8 = false) : utf8_m(utf8) {
          std::cerr << "Constructing lcs lexsim model" << std::endl;
       };
       virtual ~lexsimlcs_t() {}
       virtual double get_sim(std::string ref, std::string hyp, int mode);
+      virtual double get_sim(tokid_type ref, tokid_type hyp, int mode);
+      // similarities of ref to each of hyps, into out
+      void get_sims(tokid_type ref, const std::vector<tokid_type>& hyps, int mode, double* out);
+      virtual bool get_sims(const std::vector<tokid_type>& s1, const std::vector<tokid_type>& hyp,
+                            int mode, std::vector<double>& out);
    private:
+      double get_sim(const lcs_t& ref, const std::string& hyp);
+      bool utf8_m;
    }; // class lexsimlcs_t
 
    class lexsimw2v_t:public lexsimmodel_t {
@@ -84,39 +121,67 @@ namespace yisi {
       lexsimw2v_t() {
          dimension_m = 0;
          func_m = "";
+         simfunc_m = COSINE_FUNC;
       }
-      lexsimw2v_t(std::string outw2v_path);
+      lexsimw2v_t(std::string outw2v_path, const wordset_type* outvocab = NULL);
       virtual ~lexsimw2v_t() {}
-      std::vector<double>& get_wv(std::string word, int mode);
+      std::vector<double> get_wv(std::string word, int mode);
+      virtual embrow_t get_row(std::string word, int mode);
+      // row of an interned token, looked up once per id and mode
+      embrow_t get_row(tokid_type id, int mode);
+      virtual void prepare(bool inp);
       virtual double get_sim(std::string ref, std::string hyp, int mode);
-      virtual double get_sim(std::vector<double>& ref, std::vector<double>& hyp);
+      virtual double get_sim(tokid_type ref, tokid_type hyp, int mode);
+      virtual double get_sim(const vecview_t& ref, const vecview_t& hyp);
+      virtual double get_sim(const embrow_t& ref, const embrow_t& hyp);
+      // cosine similarities from one blocked product of the rows
+      virtual bool get_sims(const std::vector<tokid_type>& s1, const std::vector<tokid_type>& hyp,
+                            int mode, std::vector<double>& out);
       void write_txtw2v(std::string path);
+      void write_mmw2v(std::string path);
    protected:
-      std::map<std::string, std::vector<double> > outembeddings_m;
+      // whether the pair counts as the same word, with a similarity of 1.0
+      virtual bool same_token(tokid_type s1, tokid_type hyp, int mode);
+      void read_outw2v(std::string outw2v_path, const wordset_type* outvocab);
+      embtable_t outembeddings_m;
       std::string func_m;
+      simfunc_type simfunc_m;
       int dimension_m;
+   private:
+      // rows of the interned tokens for the input (0) and output (1) side,
+      // filled by prepare() before the scoring starts and only read after
+      std::vector<embrow_t> idrow_m[2];
    }; // class lexsimw2v_t
 
    class lexsimemb_t:public lexsimmodel_t {
    public:
       lexsimemb_t() {
          func_m = "cosine";
+         simfunc_m = get_simfunc(func_m);
       }
       virtual ~lexsimemb_t() {}
       virtual double get_sim(std::string ref, std::string hyp, int mode);
-      virtual double get_sim(std::vector<double>& ref, std::vector<double>& hyp);
+      virtual double get_sim(const vecview_t& ref, const vecview_t& hyp);
+      virtual double get_sim(const embrow_t& ref, const embrow_t& hyp);
+      // cosine similarities of the unit embeddings from one blocked product
+      virtual bool get_sims(const matview_t& s1, const matview_t& hyp, std::vector<double>& out);
    protected:
       std::string func_m;
+      simfunc_type simfunc_m;
    }; // class lexsimw2v_t
 
    class lexsimemapw2v_t:public lexsimw2v_t {
    public:
       lexsimemapw2v_t() {}
-      lexsimemapw2v_t(std::string emap_path, std::string outw2v_func);
+      lexsimemapw2v_t(std::string emap_path, std::string outw2v_path,
+                      const wordset_type* inpvocab = NULL, const wordset_type* outvocab = NULL);
       virtual ~lexsimemapw2v_t() {}
-      std::vector<double>& get_wv(std::string word, int mode);
+      using lexsimw2v_t::get_sim;
+      using lexsimw2v_t::get_row;
+      virtual embrow_t get_row(std::string word, int mode);
       virtual double get_sim(std::string s1, std::string hyp, int mode);
-      virtual double get_sim(std::vector<double>& s1, std::vector<double>& hyp);
+   protected:
+      virtual bool same_token(tokid_type s1, tokid_type hyp, int mode);
    private:
       std::map<std::string, std::string> emap_m;
    }; // class lexsimemapw2v_t
@@ -135,40 +200,75 @@ namespace yisi {
    class lexsimbiw2v_t:public lexsimw2v_t {
    public:
       lexsimbiw2v_t() {}
-      lexsimbiw2v_t(std::string inpw2v_path, std::string outw2v_path);
+      lexsimbiw2v_t(std::string inpw2v_path, std::string outw2v_path,
+                    const wordset_type* inpvocab = NULL, const wordset_type* outvocab = NULL);
       virtual ~lexsimbiw2v_t() {};
-      std::vector<double>& get_wv(std::string word, int mode);
+      using lexsimw2v_t::get_sim;
+      using lexsimw2v_t::get_row;
+      virtual embrow_t get_row(std::string word, int mode);
       virtual double get_sim(std::string s1, std::string hyp, int mode);
-      virtual double get_sim(std::vector<double>& s1, std::vector<double>& hyp);
+   protected:
+      virtual bool same_token(tokid_type s1, tokid_type hyp, int mode);
    private:
-      std::map<std::string, std::vector<double> > inpembeddings_m;
+      bool has_wv(const embtable_t& model, std::string word);
+      embtable_t inpembeddings_m;
    }; // class lexsimbiw2v_t
 
    class lexsim_t {
    public:
       lexsim_t();
-      lexsim_t(std::string name, std::string out_path="", std::string inp_path="");
+      lexsim_t(std::string name, std::string out_path="", std::string inp_path="",
+               std::string outvocab_path="", std::string inpvocab_path="");
       lexsim_t(lexsim_t& rhs);
       ~lexsim_t();
       double get_sim(std::string s1, std::string hyp, int mode);
-      double get_sim(std::vector<double>& s1, std::vector<double>& hyp);
-      std::vector<double>& get_wv(std::string word, int mode);
+      double get_sim(tokid_type s1, tokid_type hyp, int mode);
+      double get_sim(const vecview_t& s1, const vecview_t& hyp);
+      double get_sim(const embrow_t& s1, const embrow_t& hyp);
+      // out[i * hyp.size() + j] = get_sim(s1[i], hyp[j])
+      void get_sims(const matview_t& s1, const matview_t& hyp, std::vector<double>& out);
+      // out[i * hyp.size() + j] = get_sim(s1[i], hyp[j], mode)
+      void get_sims(const std::vector<tokid_type>& s1, const std::vector<tokid_type>& hyp,
+                    int mode, std::vector<double>& out);
+      std::vector<double> get_wv(std::string word, int mode);
+      // looks up the interned tokens ahead of the scoring
+      void prepare(bool inp) { lexsim_p->prepare(inp); }
       void write_txtw2v(std::string path) { lexsim_p->write_txtw2v(path); }
+      void write_mmw2v(std::string path) { lexsim_p->write_mmw2v(path); }
+      // identifies the model in the similarity cache
+      std::string get_fingerprint();
    private:
+      void init(std::string name, std::string out_path, std::string inp_path,
+                std::string outvocab_path, std::string inpvocab_path);
       lexsimmodel_t* lexsim_p;
       std::string lexsim_name_m;
       std::string outlexsim_path_m;
       std::string inplexsim_path_m;
+      std::string outvocab_path_m;
+      std::string inpvocab_path_m;
    }; // class lexsim_t
 
-   void read_binw2v(std::string path, std::map<std::string, std::vector<double> >& model, int& dimension);
-   void read_txtw2v(std::string path, std::map<std::string, std::vector<double> >& model, int& dimension);
-   std::vector<double>& get_wv(std::map<std::string, std::vector<double> >& model, std::string word);
-   double get_sim(std::vector<double>& v1, std::vector<double>& v2, std::string func);
+   void read_w2v(std::string path, embtable_t& model, int& dimension,
+                 const wordset_type* filter = NULL);
+   void read_binw2v(std::string path, embtable_t& model, int& dimension,
+                    const wordset_type* filter = NULL);
+   void read_txtw2v(std::string path, embtable_t& model, int& dimension,
+                    const wordset_type* filter = NULL);
+   void read_mmw2v(std::string path, embtable_t& model, int& dimension);
+   wordset_type read_wordset(std::string paths);
+   double get_sim(const vecview_t& v1, const vecview_t& v2, std::string func);
+   double get_sim(const embrow_t& v1, const embrow_t& v2, std::string func);
    bool sort_helper(std::pair<std::string, double> i, std::pair<std::string, double> j);
-   double simfunc(std::string funcname, std::vector<double>& ref, std::vector<double>& hyp);
-   double cosine(std::vector<double>& ref, std::vector<double>& hyp, int mode);
-   double jaccard(std::vector<double>& ref, std::vector<double>& hyp, int mode);
+   double simfunc(std::string funcname, const vecview_t& ref, const vecview_t& hyp);
+   double simfunc(std::string funcname, const embrow_t& ref, const embrow_t& hyp);
+   double simfunc(simfunc_type func, const vecview_t& ref, const vecview_t& hyp);
+   double simfunc(simfunc_type func, const embrow_t& ref, const embrow_t& hyp);
+   double cosine(const vecview_t& ref, const vecview_t& hyp, int mode);
+   double cosine(const embrow_t& ref, const embrow_t& hyp, int mode);
+   // cosine of rows of lengths reflen and hyplen given their dot product
+   double cosine(double dot, double reflen, double hyplen, int mode);
+   double jaccard(const vecview_t& ref, const vecview_t& hyp, int mode);
+   double jaccard(const embrow_t& ref, const embrow_t& hyp, int mode);
 
 } // yisi
 
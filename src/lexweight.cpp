@@ -44,6 +44,20 @@ double lexweightmodel_t::get_weight(string lex) {
   return log2(1 + ((N + 1.0) / (c + 1.0)));
 }
 
+double lexweightmodel_t::get_weight(tokid_type lexid) {
+   if (lexid < idweight_m.size()) {
+      return idweight_m[lexid];
+   }
+   // tokens interned after prepare() are weighted directly
+   return get_weight(get_vocab().get_token(lexid));
+}
+
+void lexweightmodel_t::prepare() {
+   for (tokid_type id = idweight_m.size(); id < get_vocab().size(); id++) {
+      idweight_m.push_back(get_weight(get_vocab().get_token(id)));
+   }
+}
+
 void lexweightmodel_t::write(std::ostream& os) {
   os<<N<<endl;
   for (auto it = lexweight_m.begin(); it != lexweight_m.end(); it++) {
@@ -186,6 +200,10 @@ double lexweight_t::operator()(string lex) {
    return w;
 }
 
+double lexweight_t::operator()(tokid_type lexid) {
+   return lexweight_p->get_weight(lexid);
+}
+
 void lexweight_t::write(ostream& os) {
    lexweight_p->write(os);
 }
@@ -22,6 +22,8 @@
 #ifndef LEXWEIGHT_H
 #define LEXWEIGHT_H
 
+#include "vocab.h"
+
 #include <string>
 #include <vector> 
 #include <map>
@@ -41,11 +43,17 @@ namespace yisi {
       virtual ~lexweightmodel_t() {}
 
       virtual double get_weight(std::string lex);
+      // weight of an interned token, read from the table filled by prepare()
+      double get_weight(tokid_type lexid);
+      // called once all the sentences are read, before any concurrent scoring
+      void prepare();
       void write(std::ostream& os);
       void read(std::string path);
    protected:
       std::map<std::string, double> lexweight_m;
       double N;
+   private:
+      std::vector<double> idweight_m;
    }; // class lexweightmodel_t
 
    class lexweightuniform_t:public lexweightmodel_t {
@@ -83,7 +91,11 @@ namespace yisi {
       lexweight_t(lexweight_t& rhs);
       ~lexweight_t();
       double operator()(std::string lex);
+      double operator()(tokid_type lexid);
+      void prepare() { lexweight_p->prepare(); }
       void write(std::ostream& os);
+      // identifies the model in the similarity caches
+      std::string get_fingerprint() { return lexweight_name_m + "\t" + lexweight_path_m; }
    private:
       lexweightmodel_t* lexweight_p;
       std::string lexweight_name_m;
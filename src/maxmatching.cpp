@@ -16,400 +16,521 @@
 
 #include "maxmatching.h"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
 using namespace yisi;
 using namespace std;
 
-maxmatching_t::maxmatching_t(){
-   n=0;
-   z0_r=0;
-   z0_c=0;
-   original_length = 0;
-   original_width = 0;
-}
+namespace {
 
-void maxmatching_t::add_weight(id_type srcid, id_type tgtid, weight_type weight) {
-   id_type hid, tid;
+   // most columns solved by enumeration; above this the Hungarian algorithm
+   // below is faster
+   const size_t MAX_SMALL = 5;
 
-   if (src_idx.count(srcid) > 0) {
-      hid = src_idx[srcid];
-   } else {
-      hid = src_idx.size();
-      src_idx[srcid] = hid;
-      src_rev[hid] = srcid;
-      vector<weight_type> v;
-      vector<weight_type> e;
-      for (id_type i = 0; i < tgt_idx.size(); i++) {
-         v.push_back(0.0);
-         e.push_back(0.0);
+   // a single row is matched to its heaviest column
+   void match_row(const double* w, size_t m, size_t* rowof) {
+      size_t best = 0;
+      for (size_t j = 1; j < m; j++) {
+         if (w[j] > w[best]) {
+            best = j;
+         }
       }
-      c_m.push_back(v);
-      edge_w.push_back(e);
+      fill(rowof, rowof + m, 1);
+      rowof[best] = 0;
    }
 
-   if (tgt_idx.count(tgtid) > 0) {
-      tid = tgt_idx[tgtid];
-   } else {
-      tid = tgt_idx.size();
-      tgt_idx[tgtid] = tid;
-      tgt_rev[tid] = tgtid;
-      for (id_type i = 0; i < src_idx.size(); i++) {
-         c_m[i].push_back(0.0);
-         edge_w[i].push_back(0.0);
+   /*
+    * Bitmask dynamic program for n rows and M >= n columns: best[mask] is the
+    * best weight matching the first |mask| rows to the columns in mask, and
+    * each mask is extended by one column for the next row. It runs in
+    * O(2^M M) with everything on the stack.
+    * rowof[j] is set to the row matched to column j, n if none.
+    */
+   template <size_t M>
+   void match_small(const double* w, size_t n, size_t* rowof) {
+      const size_t size = 1 << M;
+      const double inf = numeric_limits<double>::infinity();
+      double best[size];
+      unsigned char rows[size]; // |mask|
+      unsigned char last[size]; // column matched to row |mask| - 1
+      best[0] = 0.0;
+      rows[0] = 0;
+      for (size_t mask = 1; mask < size; mask++) {
+         best[mask] = -inf;
+         rows[mask] = rows[mask >> 1] + (mask & 1);
       }
-   }
-   edge_w[hid][tid] = weight;
-   c_m[hid][tid] = 1.0 - weight;
-}
-
-vector<pair<pair<maxmatching_t::id_type, maxmatching_t::id_type>,
-      maxmatching_t::weight_type> > maxmatching_t::run() {
-
-   //patch zero if the cost matrix is not square
-   original_length = src_idx.size();
-   original_width = tgt_idx.size();
-   int ssize = original_length;
-   int tsize = original_width;
-   while (ssize < tsize) {
-      vector<weight_type> v;
-      c_m.push_back(v);
-      for (int i = 0; i < tsize; i++) {
-         c_m[ssize].push_back(0.0);
+      size_t result = 0;
+      bool found = false;
+      for (size_t mask = 0; mask < size; mask++) {
+         size_t i = rows[mask];
+         if (i == n) {
+            if (!found || best[mask] > best[result]) {
+               result = mask;
+               found = true;
+            }
+            continue;
+         }
+         const double* row = w + i * M;
+         for (size_t j = 0; j < M; j++) {
+            size_t next = mask | (1 << j);
+            if (next != mask && best[mask] + row[j] > best[next]) {
+               best[next] = best[mask] + row[j];
+               last[next] = j;
+            }
+         }
       }
-      ssize++;
-   }
-   while (tsize < ssize) {
-      for (int i = 0; i < ssize; i++) {
-         c_m[i].push_back(0.0);
+      fill(rowof, rowof + M, n);
+      for (size_t mask = result; mask != 0; mask ^= 1 << last[mask]) {
+         rowof[last[mask]] = rows[mask] - 1;
       }
-      tsize++;
    }
-   n = ssize;
-
-   // run the Munkres algorithm
-   for (int i = 0; i < n; i++) {
-      row_covered.push_back(false);
-      col_covered.push_back(false);
-      vector<int> v;
-      marked.push_back(v);
-      for (int j = 0; j < n; j++) {
-         marked[i].push_back(0);
-      }
+
+   /*
+    * Scratch space of the general solver, one per thread. The buffers only
+    * grow, to the largest matching seen.
+    */
+   struct workspace_t {
+      vector<double> w_m;
+      vector<size_t> rowof_m;
+      vector<double> u_m;
+      vector<double> v_m;
+      vector<size_t> root_m;
+      vector<size_t> way_m;
+      vector<double> minv_m;
+      vector<char> used_m;
+      // components of the sparse matching
+      vector<size_t> parent_m;
+      vector<size_t> start_m;
+      vector<size_t> nodes_m;
+      vector<double> sub_m;
+      vector<size_t> subrowof_m;
+      // pairs of the greedy matching, and the exact one it is compared to
+      vector<size_t> pairs_m;
+      vector<char> taken_m;
+      vector<size_t> exactrowof_m;
+      // greedy matchings of the thread so far
+      size_t greedyruns_m;
+
+      workspace_t() : greedyruns_m(0) {}
+   }; // struct workspace_t
+
+   workspace_t& get_workspace() {
+      static thread_local workspace_t workspace;
+      return workspace;
    }
 
-   z0_r = 0;
-   z0_c = 0;
-   for (int i = 0; i < 2 * n; i++) {
-      vector<int> v;
-      path.push_back(v);
-      for (int j = 0; j < 2 * n; j++) {
-         path[i].push_back(0);
+   /*
+    * Hungarian algorithm with shortest augmenting paths on the cost -w, for
+    * n rows and m >= n columns. Rows are added one at a time; row i is
+    * matched by growing a Dijkstra tree of reduced costs from it until a
+    * free column is reached, then flipping the path. u and v are the row and
+    * column potentials and column m is the virtual root of the tree.
+    * rowof[j] is set to the row matched to column j, n if none.
+    */
+   void match_general(const double* w, size_t n, size_t m, size_t* rowof, workspace_t& ws) {
+      const double inf = numeric_limits<double>::infinity();
+      vector<double>& u = ws.u_m;
+      vector<double>& v = ws.v_m;
+      vector<size_t>& root = ws.root_m;
+      vector<size_t>& way = ws.way_m;
+      vector<double>& minv = ws.minv_m;
+      vector<char>& used = ws.used_m;
+      u.assign(n + 1, 0.0);
+      v.assign(m + 1, 0.0);
+      root.assign(m + 1, n);
+      way.assign(m + 1, m);
+      minv.resize(m + 1);
+      used.resize(m + 1);
+      for (size_t i = 0; i < n; i++) {
+         root[m] = i;
+         size_t j0 = m;
+         fill(minv.begin(), minv.end(), inf);
+         fill(used.begin(), used.end(), 0);
+         do {
+            used[j0] = 1;
+            size_t i0 = root[j0];
+            const double* row = w + i0 * m;
+            double delta = inf;
+            size_t j1 = m;
+            for (size_t j = 0; j < m; j++) {
+               if (!used[j]) {
+                  double cur = -row[j] - u[i0] - v[j];
+                  if (cur < minv[j]) {
+                     minv[j] = cur;
+                     way[j] = j0;
+                  }
+                  if (minv[j] < delta) {
+                     delta = minv[j];
+                     j1 = j;
+                  }
+               }
+            }
+            for (size_t j = 0; j <= m; j++) {
+               if (used[j]) {
+                  u[root[j]] += delta;
+                  v[j] -= delta;
+               } else {
+                  minv[j] -= delta;
+               }
+            }
+            j0 = j1;
+         } while (root[j0] != n);
+         // flip the augmenting path back to the root
+         do {
+            size_t j1 = way[j0];
+            root[j0] = root[j1];
+            j0 = j1;
+         } while (j0 != m);
       }
+      copy(root.begin(), root.begin() + m, rowof);
    }
 
-   bool done = false;
-   int step = 1;
-   while (!done) {
-      switch (step) {
-      case 1:
-         step = step1();
-         break;
+   /*
+    * Matches n rows to m >= n columns with the cheapest of the solvers above.
+    * rowof[j] is set to the row matched to column j, n if none.
+    */
+   void match(const double* w, size_t n, size_t m, size_t* rowof) {
+      if (n == 1) {
+         match_row(w, m, rowof);
+         return;
+      }
+      switch (m) {
       case 2:
-         step = step2();
+         match_small<2>(w, n, rowof);
          break;
       case 3:
-         step = step3();
+         match_small<3>(w, n, rowof);
          break;
       case 4:
-         step = step4();
+         match_small<4>(w, n, rowof);
          break;
       case 5:
-         step = step5();
-         break;
-      case 6:
-         step = step6();
+         match_small<5>(w, n, rowof);
          break;
       default:
-         done = true;
+         match_general(w, n, m, rowof, get_workspace());
       }
    }
 
-   vector<pair<pair<id_type, id_type>, weight_type> > result;
-
-   for (int i = 0; i < original_length; i++) {
-      for (int j = 0; j < original_width; j++) {
-         if (marked[i][j] == 1) {
-            pair<id_type, id_type> e(src_rev[i], tgt_rev[j]);
-            pair<pair<id_type, id_type>, weight_type> r(e, edge_w[i][j]);
-            result.push_back(r);
-         }
+   size_t find_root(vector<size_t>& parent, size_t k) {
+      while (parent[k] != k) {
+         parent[k] = parent[parent[k]];
+         k = parent[k];
       }
+      return k;
    }
 
-   return result;
-} // run
-
-/*
- * Munkres algorithm step 1 helper function
- *   For each row of the matrix, find the smallest element
- *   and subtract it from every element in its row.
- *   Go to step 2 at the end.
- */
-int maxmatching_t::step1() {
-   for (int i = 0; i < n; i++) {
-      double minval = 100.0;
-      for (int j = 0; j < n; j++) {
-         if (c_m[i][j] < minval) {
-            minval = c_m[i][j];
+   /*
+    * Matches n rows to m >= n columns keeping only the weights above epsilon:
+    * the rows and columns are split into the connected components of the
+    * kept weights, and each component is matched on its own, a single pair
+    * directly. Rows left out are not matched; rowof[j] is set as in match.
+    */
+   void match_components(const double* w, size_t n, size_t m, double epsilon,
+                         size_t* rowof, workspace_t& ws) {
+      // union-find over the rows 0..n-1 and the columns n..n+m-1
+      vector<size_t>& parent = ws.parent_m;
+      parent.resize(n + m);
+      for (size_t k = 0; k < n + m; k++) {
+         parent[k] = k;
+      }
+      for (size_t i = 0; i < n; i++) {
+         for (size_t j = 0; j < m; j++) {
+            if (w[i * m + j] > epsilon) {
+               parent[find_root(parent, i)] = find_root(parent, n + j);
+            }
          }
       }
-      for (int j = 0; j < n; j++) {
-         c_m[i][j] -= minval;
+      // the nodes of each component, rows then columns, in order
+      vector<size_t>& start = ws.start_m;
+      vector<size_t>& nodes = ws.nodes_m;
+      start.assign(n + m + 1, 0);
+      nodes.resize(n + m);
+      for (size_t k = 0; k < n + m; k++) {
+         parent[k] = find_root(parent, k);
+         start[parent[k] + 1]++;
+      }
+      for (size_t k = 0; k < n + m; k++) {
+         start[k + 1] += start[k];
+      }
+      for (size_t k = 0; k < n + m; k++) {
+         nodes[start[parent[k]]++] = k;
       }
-   }
-   return 2;
-}
 
-/*
- * Munkres algorithm step 2 helper function
- *   Find a zero (Z) in the resulting matrix.
- *   If there is no starred zero in its row or column, star Z.
- *   Repeat for each element in the matrix.
- *   Go the step 3 at the end.
- */
-int maxmatching_t::step2() {
-   for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-         if (c_m[i][j] == 0.0 && !row_covered[i] && !col_covered[j]) {
-            marked[i][j] = 1;
-            row_covered[i] = true;
-            col_covered[j] = true;
+      fill(rowof, rowof + m, n);
+      for (size_t first = 0; first < n + m;) {
+         size_t last = first + 1;
+         while (last < n + m && parent[nodes[last]] == parent[nodes[first]]) {
+            last++;
+         }
+         const size_t* rows = &nodes[first];
+         size_t r = 0;
+         while (first + r < last && rows[r] < n) {
+            r++;
+         }
+         const size_t* cols = rows + r;
+         size_t c = last - first - r;
+         first = last;
+         if (r == 0 || c == 0) {
+            continue;
+         } else if (r == 1 && c == 1) {
+            rowof[cols[0] - n] = rows[0];
+            continue;
+         }
+         // the component, with the smaller side as rows
+         bool flip = r > c;
+         size_t sn = flip ? c : r;
+         size_t sm = flip ? r : c;
+         ws.sub_m.resize(sn * sm);
+         ws.subrowof_m.resize(sm);
+         double* sub = ws.sub_m.data();
+         size_t* subrowof = ws.subrowof_m.data();
+         for (size_t a = 0; a < r; a++) {
+            for (size_t b = 0; b < c; b++) {
+               double weight = w[rows[a] * m + cols[b] - n];
+               (flip ? sub[b * sm + a] : sub[a * sm + b]) = weight > epsilon ? weight : 0.0;
+            }
+         }
+         match(sub, sn, sm, subrowof);
+         for (size_t k = 0; k < sm; k++) {
+            if (subrowof[k] != sn) {
+               if (flip) {
+                  rowof[cols[subrowof[k]] - n] = rows[k];
+               } else {
+                  rowof[cols[k] - n] = rows[subrowof[k]];
+               }
+            }
          }
       }
    }
-   //clear covers
-   for (int i = 0; i < n; i++) {
-      row_covered[i] = false;
-      col_covered[i] = false;
+
+   /*
+    * Matches n rows to m columns greedily by decreasing weight, ties in
+    * row-major order, among the weights above threshold. rowof[j] is set as
+    * in match.
+    */
+   void match_greedy(const double* w, size_t n, size_t m, double threshold,
+                     size_t* rowof, workspace_t& ws) {
+      vector<size_t>& pairs = ws.pairs_m;
+      pairs.clear();
+      for (size_t k = 0; k < n * m; k++) {
+         if (w[k] > threshold) {
+            pairs.push_back(k);
+         }
+      }
+      sort(pairs.begin(), pairs.end(), [w](size_t a, size_t b) {
+         return w[a] > w[b] || (w[a] == w[b] && a < b);
+      });
+      vector<char>& taken = ws.taken_m;
+      taken.assign(n, 0);
+      fill(rowof, rowof + m, n);
+      size_t matched = 0;
+      for (auto it = pairs.begin(); it != pairs.end() && matched < n; it++) {
+         size_t i = *it / m;
+         size_t j = *it % m;
+         if (rowof[j] == n && !taken[i]) {
+            rowof[j] = i;
+            taken[i] = 1;
+            matched++;
+         }
+      }
    }
-   return 3;
-}
 
-/*
- * Munkres algorithm step 3 helper function
- *   Cover each column containing a starred zero.
- *   If K columns are covered,
- *   the starred zeros describe a complete set of unique assignments.
- *   In this case, go to DONE, otherwise, go to step 4 at the end.
- */
-int maxmatching_t::step3() {
-   int count = 0;
-   for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-         if (marked[i][j] == 1) {
-            col_covered[j] = true;
-            count += 1;
+   // total weight of the pairs above threshold
+   double matched_weight(const double* w, size_t n, size_t m, double threshold, const size_t* rowof) {
+      double result = 0.0;
+      for (size_t j = 0; j < m; j++) {
+         if (rowof[j] != n && w[rowof[j] * m + j] > threshold) {
+            result += w[rowof[j] * m + j];
          }
       }
+      return result;
    }
-   if (count >= n) {
-      return 7;
-   } else {
-      return 4;
+
+   struct matchingstats_t {
+      matchingstats_t() : count_m(0), greedy_m(0.0), exact_m(0.0), worst_m(1.0) {}
+      std::mutex mutex_m;
+      size_t count_m;
+      double greedy_m;
+      double exact_m;
+      // lowest ratio of greedy to exact weight
+      double worst_m;
+   }; // struct matchingstats_t
+
+   matchingstats_t& get_matchingstats() {
+      static matchingstats_t stats;
+      return stats;
    }
+
+} // namespace
+
+maxmatching_t::maxmatching_t() {
+   last_src_m = 0;
+   last_tgt_m = 0;
 }
 
-/*
- * Munkres algorithm step 4 helper function
- *   Find a uncovered zero and prime it.
- *   If there is no starred zero in the two containing this primed zero,
- *   go to step 5,
- *   otherwise, cover this row and
- *   uncover the column containing the starred zero.
- *   Continue in this manner until there are no uncovered zeros left.
- *   Save the smallest uncovered vallue and go to step 6.
- */
-int maxmatching_t::step4() {
-   int step = 0;
-   bool done = false;
-   int row = -1;
-   int col = -1;
-   int star_col = -1;
-   while (!done) {
-      find_a_zero(row, col);
-      if (row < 0) {
-         done = true;
-         step = 6;
-      } else {
-         marked[row][col] = 2;
-         star_col = find_star_in_row(row);
-         if (star_col >= 0) {
-            col = star_col;
-            row_covered[row] = true;
-            col_covered[col] = false;
-         } else {
-            done = true;
-            z0_r = row;
-            z0_c = col;
-            step = 5;
-         }
+void maxmatching_t::set_config(const config_t& config) {
+   config_m = config;
+}
+
+void maxmatching_t::clear() {
+   src_rev.clear();
+   tgt_rev.clear();
+   edges_m.clear();
+   last_src_m = 0;
+   last_tgt_m = 0;
+}
+
+size_t maxmatching_t::get_index(vector<id_type>& rev, size_t hint, id_type id) {
+   if (hint < rev.size() && rev[hint] == id) {
+      return hint;
+   }
+   for (size_t i = 0; i < rev.size(); i++) {
+      if (rev[i] == id) {
+         return i;
       }
    }
-   return step;
+   rev.push_back(id);
+   return rev.size() - 1;
 }
 
-/*
- * Munkres algorithm step 5 helper function
- *   Construct a series of alternating primed and starred zeros as follows:
- *   Let Z0 represent the uncovered primed zero found in step 4.
- *   Let Z1 denote the started zero in the column of Z0 (if any).
- *   Let Z2 denote the primed zero in the row of Z1 (there will always be one.
- *   Continue until the series teminates at a primed zero
- *   that has not starred zero in its column.
- *   Unstar each starred zero of the series,
- *   star each primed zero of the series,
- *   erase all orimes and uncover every line in the matrix.
- *   Go to step 3.
- */
-int maxmatching_t::step5() {
-   int count = 0;
-   path[count][0] = z0_r;
-   path[count][1] = z0_c;
-   bool done = false;
-   while (!done) {
-      int row = find_star_in_col(path[count][1]);
-      if (row >= 0) {
-         count += 1;
-         path[count][0] = row;
-         path[count][1] = path[count - 1][1];
-      } else {
-         done = true;
-      }
-      if (!done) {
-         int col = find_prime_in_row(path[count][0]);
-         count += 1;
-         path[count][0] = path[count - 1][0];
-         path[count][1] = col;
-      }
+void maxmatching_t::add_weight(id_type srcid, id_type tgtid, weight_type weight) {
+   // weights come row by row: the same source, then the next target
+   edge_t edge;
+   edge.src_m = get_index(src_rev, last_src_m, srcid);
+   edge.tgt_m = get_index(tgt_rev, last_tgt_m + 1 < tgt_rev.size() ? last_tgt_m + 1 : 0, tgtid);
+   edge.weight_m = weight;
+   edges_m.push_back(edge);
+   last_src_m = edge.src_m;
+   last_tgt_m = edge.tgt_m;
+}
+
+maxmatching_t::result_type maxmatching_t::run() {
+   result_type result;
+   run(result);
+   return result;
+}
+
+void maxmatching_t::run(result_type& result) {
+   result.clear();
+
+   // the rows are the smaller side, so that every row gets matched
+   size_t nsrc = src_rev.size();
+   size_t ntgt = tgt_rev.size();
+   bool transposed = nsrc > ntgt;
+   size_t n = transposed ? ntgt : nsrc;
+   size_t m = transposed ? nsrc : ntgt;
+   if (n == 0) {
+      return;
    }
+   bool small = m <= MAX_SMALL;
 
-   //convert path
-   for (int i = 0; i < count + 1; i++) {
-      if (marked[path[i][0]][path[i][1]] == 1) {
-         marked[path[i][0]][path[i][1]] = 0;
+   // weights, row-major; a later weight of the same pair wins
+   weight_type small_w[MAX_SMALL * MAX_SMALL];
+   size_t small_rowof[MAX_SMALL];
+   workspace_t* ws = NULL;
+   if (!small) {
+      ws = &get_workspace();
+      ws->w_m.resize(n * m);
+      ws->rowof_m.resize(m);
+   }
+   weight_type* w = small ? small_w : ws->w_m.data();
+   size_t* rowof = small ? small_rowof : ws->rowof_m.data();
+   fill(w, w + n * m, 0.0);
+   for (auto it = edges_m.begin(); it != edges_m.end(); it++) {
+      if (transposed) {
+         w[it->tgt_m * m + it->src_m] = it->weight_m;
       } else {
-         marked[path[i][0]][path[i][1]] = 1;
+         w[it->src_m * m + it->tgt_m] = it->weight_m;
       }
    }
-   //clear covers & erase primes
-   for (int i = 0; i < n; i++) {
-      row_covered[i] = false;
-      col_covered[i] = false;
-      for (int j = 0; j < n; j++) {
-         if (marked[i][j] == 2) {
-            marked[i][j] = 0;
+
+   bool sparse = config_m.epsilon_m >= 0.0;
+   weight_type threshold = sparse ? config_m.epsilon_m : 0.0;
+   if (small) {
+      // enumerated exactly whatever the config, faster than splitting it up
+      // or sorting its pairs; the weights at most the threshold count as 0
+      weight_type kept[MAX_SMALL * MAX_SMALL];
+      for (size_t k = 0; k < n * m; k++) {
+         kept[k] = w[k] > threshold ? w[k] : 0.0;
+      }
+      match(kept, n, m, rowof);
+   } else if (!config_m.greedy_m) {
+      // a dense matching is a sparse one dropping only the weights at most
+      // 0, so that epsilon 0 picks the very same pairs
+      match_components(w, n, m, threshold, rowof, get_workspace());
+   } else {
+      workspace_t& greedyws = get_workspace();
+      match_greedy(w, n, m, threshold, rowof, greedyws);
+      greedyws.greedyruns_m++;
+      if (config_m.sample_m > 0 && greedyws.greedyruns_m % config_m.sample_m == 0) {
+         greedyws.exactrowof_m.resize(m);
+         size_t* exactrowof = greedyws.exactrowof_m.data();
+         match_components(w, n, m, threshold, exactrowof, greedyws);
+         double greedy = matched_weight(w, n, m, threshold, rowof);
+         double exact = matched_weight(w, n, m, threshold, exactrowof);
+         matchingstats_t& stats = get_matchingstats();
+         std::lock_guard<std::mutex> lock(stats.mutex_m);
+         stats.count_m++;
+         stats.greedy_m += greedy;
+         stats.exact_m += exact;
+         if (exact > 0.0 && greedy / exact < stats.worst_m) {
+            stats.worst_m = greedy / exact;
          }
       }
    }
-   return 3;
-}
 
-/*
- * Munkres algorithm step 6 helper function
- *   Add the value found in step 4 to every element of each covered row,
- *   and subtract it from every element of each uncovered column.
- *   Go to step 4 without altering any stars, primes, or covered lines.
- */
-int maxmatching_t::step6() {
-   double minval = find_smallest();
-   for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-         if (row_covered[i]) {
-            c_m[i][j] += minval;
-         }
-         if (!col_covered[j]) {
-            c_m[i][j] -= minval;
-         }
+   /*
+    * Pairs at most the threshold (0 unless sparse) are no better than
+    * leaving both sides out, so free them and match the free rows and
+    * columns in order, as zero-weight ties; the rows left over by a greedy
+    * matching are matched the same way.
+    */
+   for (size_t j = 0; j < m; j++) {
+      if (rowof[j] != n && w[rowof[j] * m + j] <= threshold) {
+         rowof[j] = n;
       }
    }
-   return 4;
-}
-
-/*
- * Munkres algorithm helper function for finding min val in cost matrix
- *   Find the smallest uncovered value in the matrix.
- */
-double maxmatching_t::find_smallest() {
-   double minval = 1.0;
-   for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-         if (!row_covered[i] && !col_covered[j]) {
-            if (minval > c_m[i][j]) {
-               minval = c_m[i][j];
-            }
+   size_t j = 0;
+   for (size_t i = 0; i < n; i++) {
+      if (find(rowof, rowof + m, i) == rowof + m) {
+         while (rowof[j] != n) {
+            j++;
          }
+         rowof[j] = i;
       }
    }
-   return minval;
-}
 
-/*
- * Munkres algorithm helper function
- *   Find the first uncovered element with value 0.
- */
-void maxmatching_t::find_a_zero(int& r, int& c) {
-   r = -1;
-   c = -1;
-   for (int i = 0; i < n && r == -1; i++) {
-      for (int j = 0; j < n; j++) {
-         if (c_m[i][j] == 0 && !row_covered[i] && !col_covered[j]) {
-            r = i;
-            c = j;
+   if (transposed) {
+      // report the pairs by source, i.e. by column
+      for (size_t j = 0; j < m; j++) {
+         if (rowof[j] != n) {
+            size_t i = rowof[j];
+            result.push_back(make_pair(make_pair(src_rev[j], tgt_rev[i]), w[i * m + j]));
          }
       }
-   }
-}
-
-/*
- * Munkres algorithm helper function
- *   Find the first starred element in the specified row.
- *   Returns the column index, or -1 if no starred element was found.
- */
-int maxmatching_t::find_star_in_row(int row) {
-   int col = -1;
-   for (int j = 0; j < n && col == -1; j++) {
-      if (marked[row][j] == 1) {
-         col = j;
+   } else {
+      // report the pairs by source, i.e. by row
+      result.resize(n);
+      for (size_t j = 0; j < m; j++) {
+         if (rowof[j] != n) {
+            size_t i = rowof[j];
+            result[i] = make_pair(make_pair(src_rev[i], tgt_rev[j]), w[i * m + j]);
+         }
       }
    }
-   return col;
-}
 
-/*
- * Munkres algorithm helper function
- *   Find the first starred element in the specified col.
- *   Returns the row index, or -1 if no starred element was found.
- */
-int maxmatching_t::find_star_in_col(int col) {
-   int row = -1;
-   for (int i = 0; i < n && row == -1; i++) {
-      if (marked[i][col] == 1) {
-         row = i;
-      }
-   }
-   return row;
-}
+} // run
 
-/*
- * Munkres algorithm helper function
- *   Find the first prime element in the specified row.
- *   Returns the column index, or -1 if no prime element was found.
- */
-int maxmatching_t::find_prime_in_row(int row) {
-   int col = -1;
-   for (int j = 0; j < n && col == -1; j++) {
-      if (marked[row][j] == 2) {
-         col = j;
-      }
+void yisi::print_matching_stats(ostream& os) {
+   matchingstats_t& stats = get_matchingstats();
+   std::lock_guard<std::mutex> lock(stats.mutex_m);
+   if (stats.count_m == 0) {
+      return;
    }
-   return col;
+   os << "Greedy matching: " << stats.count_m << " sampled, "
+      << (stats.exact_m > 0.0 ? 100.0 * stats.greedy_m / stats.exact_m : 100.0)
+      << "% of the exact weight (worst " << 100.0 * stats.worst_m << "%)" << endl;
 }
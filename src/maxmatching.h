@@ -7,6 +7,36 @@
  * Class definition of maximum bipartite matching algorithm:
  *    - maxmatching_t
  *
+ * Matchings of up to 5 columns, whatever the config, are enumerated by a
+ * bitmask dynamic program on the stack, specialized on the number of
+ * columns, or matched directly for a single row; the typical SRL frame
+ * has that few roles. Larger ones are solved by the shortest augmenting
+ * path version of the Hungarian algorithm with dual potentials, in
+ * O(n^2 m) for n rows and m >= n columns. Pairs of weight at most 0 count as unmatched: the
+ * nodes they leave over are paired in order, so every node on the smaller
+ * side is matched and the result has min(#src, #tgt) pairs, sorted by
+ * source; pairs never given a weight count as weight 0. Where several
+ * matchings have the maximum weight, which one is picked depends on the
+ * solver, not on the Munkres algorithm this class used before.
+ *
+ * A matcher can be cleared and reused, and the scratch space of the
+ * solvers is kept per thread, so steady-state matching does not allocate.
+ * Ids are looked up where the row-by-row order of align() puts them first,
+ * then by a linear scan.
+ *
+ * A sparse matching drops the weights at most some epsilon, splits the
+ * rest into connected components and matches each one on its own; the
+ * nodes left over are paired in order as zero-weight ties. A dense
+ * matching goes through the same steps with an epsilon of 0, so a sparse
+ * matching with epsilon 0 gives exactly the same pairs.
+ *
+ * A greedy matching of more than 5 columns takes the pairs by decreasing
+ * weight, skipping those whose source or target is already taken, in
+ * O(nm log nm). Its total
+ * weight is at least half the maximum; a sample of the greedy matchings
+ * can be matched exactly too, to measure how far below the maximum they
+ * actually fall.
+ *
  * Multilingual Text Processing / Traitement multilingue de textes
  * Digital Technologies Research Centre / Centre de recherche en technologies numériques
  * National Research Council Canada / Conseil national de recherches Canada
@@ -17,9 +47,10 @@
 #ifndef MAXMATCHING_H
 #define MAXMATCHING_H
 
+#include <cstddef>
+#include <ostream>
 #include <utility>
-#include <vector> 
-#include <map>
+#include <vector>
 
 namespace yisi {
 
@@ -27,45 +58,56 @@ namespace yisi {
    public:
       typedef size_t id_type;
       typedef double weight_type;
+      typedef std::vector<std::pair<std::pair<id_type, id_type>, weight_type> > result_type;
 
       maxmatching_t();
 
+      // forget all the weights, keeping the buffers for the next matching
+      void clear();
+
+      struct config_t {
+         config_t() : epsilon_m(-1.0), greedy_m(false), sample_m(0) {}
+         // match sparsely, dropping the weights at most epsilon; negative
+         // for a dense matching
+         weight_type epsilon_m;
+         // match greedily instead of exactly
+         bool greedy_m;
+         // also match every sample_m-th greedy matching of a thread exactly,
+         // for print_matching_stats; 0 for none
+         size_t sample_m;
+      }; // struct config_t
+
+      void set_config(const config_t& config);
+
       void add_weight(id_type srcid, id_type tgtid, weight_type weight);
 
-      std::vector<std::pair<std::pair<id_type, id_type>, weight_type> > run();
+      result_type run();
+      // same, into result, reusing its buffer
+      void run(result_type& result);
 
    private:
-      std::vector< std::vector<double> > c_m; // cost matrix
-      std::vector<bool> row_covered;
-      std::vector<bool> col_covered;
-      int original_length;
-      int original_width;
-      int n;
-      int z0_r;
-      int z0_c;
-
-      std::vector< std::vector<int> > marked;
-      std::vector< std::vector<int> > path;
-
-      std::map<id_type, id_type> src_idx;
-      std::map<id_type, id_type> src_rev;
-      std::map<id_type, id_type> tgt_idx;
-      std::map<id_type, id_type> tgt_rev;
-      std::vector< std::vector<double> > edge_w;
-
-      int step1();
-      int step2();
-      int step3();
-      int step4();
-      int step5();
-      int step6();
-      double find_smallest();
-      void find_a_zero(int& row, int& col);
-      int find_star_in_row(int row);
-      int find_star_in_col(int col);
-      int find_prime_in_row(int row);
+      struct edge_t {
+         id_type src_m;
+         id_type tgt_m;
+         weight_type weight_m;
+      };
+
+      size_t get_index(std::vector<id_type>& rev, size_t hint, id_type id);
+
+      // ids by internal index, in the order they were first added
+      std::vector<id_type> src_rev;
+      std::vector<id_type> tgt_rev;
+      // internal indices of the last weight added
+      size_t last_src_m;
+      size_t last_tgt_m;
+      // weights in the order they were added, by internal index
+      std::vector<edge_t> edges_m;
+      config_t config_m;
    }; //class maxmatching_t
 
+   // how close the sampled greedy matchings came to the exact ones
+   void print_matching_stats(std::ostream& os);
+
 } // yisi
 
 #endif
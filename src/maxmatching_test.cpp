@@ -11,6 +11,9 @@
  * Copyright 2018, Sa Majeste la Reine du Chef du Canada
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 
 #include "maxmatching.h"
@@ -18,6 +21,32 @@
 using namespace std;
 using namespace yisi;
 
+// best total weight matching every row of w to its own column, rows <= cols,
+// by dynamic programming over the sets of used columns
+double brute_matching(const vector<vector<double> >& w) {
+   size_t cols = w[0].size();
+   vector<double> best(1 << cols, -1.0);
+   best[0] = 0.0;
+   for (unsigned used = 0; used < best.size(); used++) {
+      size_t i = __builtin_popcount(used);
+      if (best[used] < 0.0 || i == w.size()) {
+         continue;
+      }
+      for (size_t j = 0; j < cols; j++) {
+         if (!(used & (1u << j))) {
+            best[used | (1u << j)] = max(best[used | (1u << j)], best[used] + w[i][j]);
+         }
+      }
+   }
+   double result = 0.0;
+   for (unsigned used = 0; used < best.size(); used++) {
+      if ((size_t)__builtin_popcount(used) == w.size()) {
+         result = max(result, best[used]);
+      }
+   }
+   return result;
+}
+
 int main(int argc, char* argv[])
 {
    vector<pair<pair<maxmatching_t::id_type, maxmatching_t::id_type>,
@@ -170,6 +199,156 @@ int main(int argc, char* argv[])
    }
    r.clear();
 
-   return 0;
+   //test case 6
+   //ties of weight 0 are matched in order
+   // |  a|  b|  c|  d
+   //1|0.0|0.0|0.0|0.0
+   //2|0.0|0.0|0.5|0.0
+   //3|0.0|0.0|0.0|0.0
+   maxmatching_t t6;
+   for (maxmatching_t::id_type i = 0; i < 3; i++) {
+      for (maxmatching_t::id_type j = 3; j < 7; j++) {
+         t6.add_weight(i, j, (i == 1 && j == 5) ? 0.5 : 0.0);
+      }
+   }
+   r = t6.run();
+
+   cout << "Test case 6: " << endl;
+   cout << " |  3|  4|  5|  6" << endl;
+   cout << "0|0.0|0.0|0.0|0.0" << endl;
+   cout << "1|0.0|0.0|0.5|0.0" << endl;
+   cout << "2|0.0|0.0|0.0|0.0" << endl;
+   for (size_t i = 0; i < r.size(); i++) {
+      cout << "(" << r[i].first.first << "," << r[i].first.second << ","
+           << r[i].second << ")" << endl;
+   }
+   r.clear();
+
+   //test case 7
+   //greedy matching, compared with the exact one; up to 5 columns are
+   //always matched exactly, so this one has 6
+   // |  a|  b|  c|  d|  e|  f
+   //1|1.0|0.9|0.0|0.0|0.0|0.0
+   //2|0.9|0.0|0.0|0.0|0.0|0.0
+   maxmatching_t t7;
+   maxmatching_t::config_t greedyconfig;
+   greedyconfig.greedy_m = true;
+   greedyconfig.sample_m = 1;
+   t7.set_config(greedyconfig);
+   for (maxmatching_t::id_type i = 0; i < 2; i++) {
+      for (maxmatching_t::id_type j = 2; j < 8; j++) {
+         double weight = 0.0;
+         if (j == 2) {
+            weight = (i == 0) ? 1.0 : 0.9;
+         } else if (i == 0 && j == 3) {
+            weight = 0.9;
+         }
+         t7.add_weight(i, j, weight);
+      }
+   }
+   r = t7.run();
+
+   cout << "Test case 7: " << endl;
+   cout << " |  2|  3|  4|  5|  6|  7" << endl;
+   cout << "0|1.0|0.9|0.0|0.0|0.0|0.0" << endl;
+   cout << "1|0.9|0.0|0.0|0.0|0.0|0.0" << endl;
+   for (size_t i = 0; i < r.size(); i++) {
+      cout << "(" << r[i].first.first << "," << r[i].first.second << ","
+           << r[i].second << ")" << endl;
+   }
+   print_matching_stats(cout);
+   r.clear();
+
+   //test case 8
+   //up to 5 columns, a greedy matching is exact
+   // |  a|  b
+   //1|1.0|0.9
+   //2|0.9|0.0
+   maxmatching_t t8;
+   t8.set_config(greedyconfig);
+   t8.add_weight(0, 2, 1.0);
+   t8.add_weight(0, 3, 0.9);
+   t8.add_weight(1, 2, 0.9);
+   t8.add_weight(1, 3, 0.0);
+   r = t8.run();
+
+   cout << "Test case 8: " << endl;
+   cout << " |  2|  3" << endl;
+   cout << "0|1.0|0.9" << endl;
+   cout << "1|0.9|0.0" << endl;
+   for (size_t i = 0; i < r.size(); i++) {
+      cout << "(" << r[i].first.first << "," << r[i].first.second << ","
+           << r[i].second << ")" << endl;
+   }
+   r.clear();
+
+   //random matrices of varying density with some pairs left out, small and
+   //large, against all the matchings, dense, sparse and greedy; every other
+   //one has ties
+   srand(1);
+   bool ok = true;
+   bool samepairs = true;
+   maxmatching_t::result_type dense;
+   //one matcher of each kind, cleared and reused
+   maxmatching_t tr;
+   maxmatching_t sparse;
+   maxmatching_t greedy;
+   maxmatching_t::config_t config;
+   config.epsilon_m = 0.0;
+   sparse.set_config(config);
+   config.epsilon_m = -1.0;
+   config.greedy_m = true;
+   greedy.set_config(config);
+   for (int t = 0; t < 2000; t++) {
+      size_t rows = 1 + rand() % 12;
+      size_t cols = 1 + rand() % 12;
+      int zeros = rand() % 5;
+      bool coarse = t % 2 == 1;
+      bool transposed = rows > cols;
+      vector<vector<double> > w(min(rows, cols), vector<double>(max(rows, cols), 0.0));
+      tr.clear();
+      sparse.clear();
+      greedy.clear();
+      for (size_t i = 0; i < rows; i++) {
+         for (size_t j = 0; j < cols; j++) {
+            double weight = (rand() % 5 < zeros) ? 0.0 : (rand() % 1000) / 1000.0;
+            if (coarse) {
+               //few distinct weights, for many equally good matchings
+               weight = (weight * 4 > 3.0) ? 1.0 : (weight > 0.0) ? 0.5 : 0.0;
+            }
+            if (rand() % 10 > 0 || i == 0 || j == 0) {
+               tr.add_weight(i, j, weight);
+               sparse.add_weight(i, j, weight);
+               greedy.add_weight(i, j, weight);
+               (transposed ? w[j][i] : w[i][j]) = weight;
+            }
+         }
+      }
+      double best = brute_matching(w);
+      for (int k = 0; k < 3; k++) {
+         (k == 0 ? tr : k == 1 ? sparse : greedy).run(r);
+         double total = 0.0;
+         for (size_t i = 0; i < r.size(); i++) {
+            total += r[i].second;
+         }
+         if (r.size() != w.size()) {
+            ok = false;
+         } else if (k < 2 ? fabs(total - best) > 1e-9 : total < 0.5 * best - 1e-9) {
+            ok = false;
+         } else if (k == 1 && r != dense) {
+            //dropping the weights of 0 must not change a single pair
+            ok = false;
+            samepairs = false;
+         }
+         if (k == 0) {
+            dense = r;
+         }
+      }
+   }
+   r.clear();
+   cout << "Random: " << (ok ? "OK" : "FAILED") << endl;
+   cout << "Random, epsilon 0 against dense: " << (samepairs ? "same pairs" : "DIFFERENT pairs") << endl;
+
+   return ok ? 0 : 1;
 } // main
 
@@ -14,6 +14,7 @@
 #include "lexsim.h"
 
 #include <iostream>
+#include <set>
 
 using namespace std;
 using namespace yisi;
@@ -22,17 +23,25 @@ int main(int argc, char* argv[])
 {
    string inpembpath = argv[1];
    string hypembpath = argv[2];
-   map<string, vector<double> > inpemb;
-   map<string, vector<double> > hypemb;
+   embtable_t inpembtable;
+   embtable_t hypembtable;
    int dim;
-   read_binw2v(inpembpath, inpemb, dim);
-   read_binw2v(hypembpath, hypemb, dim);
+   read_binw2v(inpembpath, inpembtable, dim);
+   read_binw2v(hypembpath, hypembtable, dim);
+   set<string> inpemb;
+   set<string> hypemb;
+   for (size_t i = 0; i < inpembtable.size(); i++) {
+      inpemb.insert(inpembtable.get_word(i));
+   }
+   for (size_t i = 0; i < hypembtable.size(); i++) {
+      hypemb.insert(hypembtable.get_word(i));
+   }
 
    auto it = inpemb.begin();
    auto jt = hypemb.begin();
    while (it != inpemb.end() && jt != hypemb.end()) {
-      string inp = it->first;
-      string hyp = jt->first;
+      string inp = *it;
+      string hyp = *jt;
       if (inp == hyp) {
          cout << inp << " " << hyp << endl;
          it++;
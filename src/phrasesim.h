@@ -22,14 +22,18 @@
 #include "lexsim.h"
 #include "lexweight.h"
 #include "maxmatching.h"
+#include "simcache.h"
 
 #include <string>
 #include <vector> 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cmath>
 #include <utility>
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
 
 namespace yisi {
 
@@ -37,6 +41,9 @@ namespace yisi {
       std::string lexsim_name_m;
       std::string outlexsim_path_m;
       std::string inplexsim_path_m;
+      std::string lexsimvocab_name_m;
+      std::string outlexsimvocab_path_m;
+      std::string inplexsimvocab_path_m;
       std::string inplexweight_name_m;
       std::string inplexweight_path_m;
       std::string reflexweight_name_m;
@@ -46,25 +53,48 @@ namespace yisi {
       std::string phrasesim_name_m;
 
       int n_m;
+      int simcache_mb_m;
+      std::string readcache_path_m;
+      std::string writecache_path_m;
 
       void init(com::masaers::cmdlp::parser& p) {
          using namespace com::masaers::cmdlp;
 
          p.add(make_knob(lexsim_name_m))
                .fallback("exact")
-               .desc("Type of lex sim model: [exact(default)|ibm1|w2v|ibmw2v]")
+               .desc("Type of lex sim model: [exact(default)|ibm1|w2v|ibmw2v|lcs|lcsutf8]")
                .name("lexsim-type")
                ;
          p.add(make_knob(outlexsim_path_m))
                .fallback("")
-               .desc("Path to lex sim model file in output language")
+               .desc("Path to lex sim model file in output language "
+                     "(*bin: binary w2v | *mmw2v: memory-mapped w2v | otherwise: text w2v)")
                .name("outlexsim-path")
                ;
          p.add(make_knob(inplexsim_path_m))
                .fallback("")
-               .desc("Path to lex sim model file in input language")
+               .desc("Path to lex sim model file in input language "
+                     "(*bin: binary w2v | *mmw2v: memory-mapped w2v | otherwise: text w2v)")
                .name("inplexsim-path")
                ;
+         p.add(make_knob(lexsimvocab_name_m))
+               .fallback("all")
+               .desc("Word vectors to load from the lex sim models: [all(default) "
+                     "| test: only the types in the files being evaluated]")
+               .name("lexsimvocab-type")
+               ;
+         p.add(make_knob(outlexsimvocab_path_m))
+               .fallback("")
+               .desc("Files separated by ':' whose types are kept from the lex sim model in output "
+                     "language (default for lexsimvocab-type test: ref and hyp files and their unit files)")
+               .name("outlexsimvocab-path")
+               ;
+         p.add(make_knob(inplexsimvocab_path_m))
+               .fallback("")
+               .desc("Files separated by ':' whose types are kept from the lex sim model in input "
+                     "language (default for lexsimvocab-type test: inp file and its unit file)")
+               .name("inplexsimvocab-path")
+               ;
          p.add(make_knob(inplexweight_name_m))
                .fallback("uniform")
                .desc("Type of input lex weight model: [uniform(default)|file|learn]")
@@ -113,12 +143,24 @@ namespace yisi {
                .name("ngram-size")
                .name("n")
                ;
+         p.add(make_knob(simcache_mb_m))
+               .fallback(1024)
+               .desc("Memory budget in MB of the phrasal similarity cache (0: unbounded)")
+               .name("simcache-size")
+               ;
+         p.add(make_knob(readcache_path_m))
+               .fallback("")
+               .desc("Phrasal similarity cache file to warm-start from; entries of other models are skipped")
+               .name("readcache-path")
+               ;
+         p.add(make_knob(writecache_path_m))
+               .fallback("")
+               .desc("File to save the phrasal similarities computed to, for readcache-path")
+               .name("writecache-path")
+               ;
       }
    }; // struct phrasesim_options
 
-   static std::map<std::string, std::map<std::string, std::pair<double, double> > > mpscache_m;
-   static std::map<std::string, std::map<std::string, std::pair<double, double> > > xpscache_m;
-
    template <class opt_T>
    class phrasesim_t {
    public:
@@ -127,7 +169,8 @@ namespace yisi {
       phrasesim_t() {}
 
       phrasesim_t(opt_T opt) {
-         lexsim_p = new lexsim_t(opt.lexsim_name_m, opt.outlexsim_path_m, opt.inplexsim_path_m);
+         lexsim_p = new lexsim_t(opt.lexsim_name_m, opt.outlexsim_path_m, opt.inplexsim_path_m,
+                                 opt.outlexsimvocab_path_m, opt.inplexsimvocab_path_m);
          //std::cerr << "reflw_name\t" << opt.reflexweight_name_m << "\treflw_path\t" << opt.reflexweight_path_m
          //   << "\treflw_threshold\t" << opt.reflexweight_threshold_m << std::endl;
          reflexweight_p = new lexweight_t(opt.reflexweight_name_m, opt.reflexweight_path_m);
@@ -147,6 +190,23 @@ namespace yisi {
          hyplexweight_name_m = opt.hyplexweight_name_m;
          inplexweight_name_m = opt.inplexweight_name_m;
          n_m = opt.n_m;
+
+         std::ostringstream fingerprint;
+         fingerprint << "phrasesim\t" << lexsim_p->get_fingerprint()
+                     << "\t" << opt.reflexweight_name_m << "\t" << opt.reflexweight_path_m
+                     << yisi::get_file_stamp(opt.reflexweight_path_m)
+                     << "\t" << opt.hyplexweight_name_m << "\t" << opt.hyplexweight_path_m
+                     << yisi::get_file_stamp(opt.hyplexweight_path_m)
+                     << "\t" << opt.inplexweight_name_m << "\t" << opt.inplexweight_path_m
+                     << yisi::get_file_stamp(opt.inplexweight_path_m)
+                     << "\t" << phrasesim_name_m << "\t" << n_m;
+         fingerprint_m = fingerprint.str();
+         cachens_m = yisi::get_cachens(fingerprint_m);
+         if (opt.simcache_mb_m >= 0) {
+            yisi::set_simcache_budget(opt.simcache_mb_m);
+         }
+         readcache_path_m = opt.readcache_path_m;
+         writecache_path_m = opt.writecache_path_m;
       }
 
       phrasesim_t(phrasesim_t& rhs) {
@@ -158,6 +218,10 @@ namespace yisi {
          inplexweight_name_m = rhs.inplexweight_name_m;
          phrasesim_name_m = rhs.phrasesim_name_m;
          n_m = rhs.n_m;
+         fingerprint_m = rhs.fingerprint_m;
+         cachens_m = rhs.cachens_m;
+         readcache_path_m = rhs.readcache_path_m;
+         writecache_path_m = rhs.writecache_path_m;
       }
 
       ~phrasesim_t() {
@@ -185,7 +249,7 @@ namespace yisi {
          }
       }
 
-      double get_lexweight(std::vector<std::string>& tokens, int mode) {
+      double get_lexweight(std::vector<tokid_type>& tokens, int mode) {
          double result = 0.0;
          for (auto it = tokens.begin(); it != tokens.end(); it++) {
             auto t = *it;
@@ -200,279 +264,261 @@ namespace yisi {
          return result;
       }
 
+      // the tokens are interned, so any new one must come before the
+      // vocabulary is frozen for the scoring (see vocab_t::freeze)
       std::pair<double, double> operator()(std::vector<std::string> s1tokens,
                                            std::vector<std::string>& hyptokens, int mode) {
-         std::pair<double, double> result;
-         if (s1tokens.size() == 0 || hyptokens.size() == 0) {
-            result = std::make_pair(0.0, 0.0);
-            return result;
-         }
-         std::string s1txt;
-         size_t i;
-         for (i = 0; i < s1tokens.size() - 1; i++) {
-            s1txt = s1txt + s1tokens[i] + " ";
-         }
-         s1txt = s1txt + s1tokens[i];
-         std::string hyptxt;
-         size_t j;
-         for (j = 0; j < hyptokens.size() - 1; j++) {
-            hyptxt = hyptxt + hyptokens[j] + " ";
-         }
-         hyptxt = hyptxt + hyptokens[j];
+         auto s1ids = yisi::intern(s1tokens);
+         auto hypids = yisi::intern(hyptokens);
+         return (*this)(s1ids, hypids, mode);
+      }
 
-         if (mode == yisi::INP_MODE) {
-            if (xpscache_m.find(s1txt) != xpscache_m.end()) {
-               if (xpscache_m[s1txt].find(hyptxt) != xpscache_m[s1txt].end()) {
-                  return xpscache_m[s1txt][hyptxt];
-               }
-            } else {
-               std::map<std::string, std::pair<double, double> > c;
-               xpscache_m[s1txt] = c;
-            }
-         } else {
-            if (mpscache_m.find(s1txt) != mpscache_m.end()) {
-               if (mpscache_m[s1txt].find(hyptxt) != mpscache_m[s1txt].end()) {
-                  return mpscache_m[s1txt][hyptxt];
-               }
-            } else {
-               std::map<std::string, std::pair<double, double> > c;
-               mpscache_m[s1txt] = c;
-            }
-         }
-         auto s = nwpr(s1tokens, hyptokens, mode);
-         if (mode == yisi::INP_MODE) {
-            xpscache_m[s1txt][hyptxt] = s;
-         } else {
-            mpscache_m[s1txt][hyptxt] = s;
-         }
-         return s;
+      std::pair<double, double> operator()(std::vector<tokid_type>& s1tokens,
+                                           std::vector<tokid_type>& hyptokens, int mode) {
+         std::vector<double> sims;
+         return (*this)(s1tokens, hyptokens, [&]() {
+            get_sims(s1tokens, hyptokens, mode, sims);
+            return std::make_pair((const double*)sims.data(), hyptokens.size());
+         }, mode);
       };
 
-      std::pair<double, double> operator()(std::vector<std::string> s1tokens,
-                                           std::vector<std::string>& hyptokens,
-                                           std::vector<std::vector<double> > s1embs,
-                                           std::vector<std::vector<double> > hypembs, int mode) {
+      std::pair<double, double> operator()(std::vector<tokid_type>& s1tokens,
+                                           std::vector<tokid_type>& hyptokens,
+                                           const matview_t& s1embs,
+                                           const matview_t& hypembs, int mode) {
+         std::vector<double> sims;
+         return (*this)(s1tokens, hyptokens, [&]() {
+            get_sims(s1embs, hypembs, sims);
+            return std::make_pair((const double*)sims.data(), hyptokens.size());
+         }, mode);
+      };
+
+      // the phrasal similarity of s1tokens and hyptokens; on a cache miss,
+      // sims() gives where their token similarities are read from: the one
+      // of s1tokens[i] and hyptokens[j] is first[i * second + j], so that
+      // the phrases of a sentence pair can share the similarities of its
+      // tokens (see get_sims)
+      template <typename F>
+      std::pair<double, double> operator()(std::vector<tokid_type>& s1tokens,
+                                           std::vector<tokid_type>& hyptokens,
+                                           F sims, int mode) {
          std::pair<double, double> result;
          if (s1tokens.size() == 0 || hyptokens.size() == 0) {
             result = std::make_pair(0.0, 0.0);
             return result;
          }
-         std::string s1txt;
-         size_t i;
-         for (i = 0; i < s1tokens.size() - 1; i++) {
-            s1txt = s1txt + s1tokens[i] + " ";
-         }
-         s1txt = s1txt + s1tokens[i];
-         std::string hyptxt;
-         size_t j;
-         for (j = 0; j < hyptokens.size() - 1; j++) {
-            hyptxt = hyptxt + hyptokens[j] + " ";
-         }
-         hyptxt = hyptxt + hyptokens[j];
-
-         if (mode == yisi::INP_MODE) {
-            if (xpscache_m.find(s1txt) != xpscache_m.end()) {
-               if (xpscache_m[s1txt].find(hyptxt) != xpscache_m[s1txt].end()) {
-                  return xpscache_m[s1txt][hyptxt];
-               }
-            } else {
-               std::map<std::string, std::pair<double, double> > c;
-               xpscache_m[s1txt] = c;
-            }
-         } else {
-            if (mpscache_m.find(s1txt) != mpscache_m.end()) {
-               if (mpscache_m[s1txt].find(hyptxt) != mpscache_m[s1txt].end()) {
-                  return mpscache_m[s1txt][hyptxt];
-               }
-            } else {
-               std::map<std::string, std::pair<double, double> > c;
-               mpscache_m[s1txt] = c;
-            }
-         }
-         auto s = nwpr(s1tokens, hyptokens, s1embs, hypembs, mode);
-         if (mode == yisi::INP_MODE) {
-            xpscache_m[s1txt][hyptxt] = s;
-         } else {
-            mpscache_m[s1txt][hyptxt] = s;
+         const phrasesimkey_t& key = get_cachekey(s1tokens, hyptokens, mode);
+         if (get_phrasesimcache().get(key, result)) {
+            return result;
          }
+         std::pair<const double*, size_t> view = sims();
+         auto s = nwpr(s1tokens, hyptokens, view.first, view.second, mode);
+         get_phrasesimcache().put(key, s);
          return s;
-      };
+      }
 
-      std::pair<double, double> ngram(std::vector<std::string>& s1tokens,
-                                      std::vector<std::string>& hyptokens, int mode) {
-         //std::cerr<<"ng: " << s1tokens.size()<<std::endl;
-         //std::cerr<<"ng: " << hyptokens.size()<<std::endl;
-         if (s1tokens.size() != hyptokens.size()) {
-            std::cerr << "ERROR: Failed to compute n-gram similarity - "
-               << "s1 n-gram size != hyp n-gram size. Exiting..." << std::endl;
-            exit(1);
-         }
-         double presult = 0.0;
-         double rresult = 0.0;
-         double plen = 0.0;
-         double rlen = 0.0;
-         for (size_t i = 0; i < s1tokens.size(); i++) {
-            double rw = 0.0;
-            double pw = 0.0;
-            double ls = 0.0;
-            if (mode == yisi::INP_MODE) {
-               rw = (*inplexweight_p)(s1tokens[i]);
-            } else if (mode == yisi::REF_MODE) {
-               rw = (*reflexweight_p)(s1tokens[i]);
-            }
-            pw = (*hyplexweight_p)(hyptokens[i]);
-            //std::cerr << s1tokens[i] << " ||| " << hyptokens[i] <<" ||| "<<rw <<" ||| " <<pw << " ||| ";
-            ls = lexsim_p->get_sim(s1tokens[i], hyptokens[i], mode);
-            //std::cerr << ls << std::endl;
-            rresult += rw * ls;
-            presult += pw * ls;
-            rlen += rw;
-            plen += pw;
-         }
-         //std::cerr<<"(" << presult / plen<<","<<rresult / rlen<< ")"<<std::endl;
-         std::pair<double, double> result = std::make_pair(presult / plen, rresult / rlen);
-         return result;
+      // out[i * hyptokens.size() + j] is the similarity of s1tokens[i] and hyptokens[j]
+      void get_sims(const std::vector<tokid_type>& s1tokens,
+                    const std::vector<tokid_type>& hyptokens, int mode,
+                    std::vector<double>& out) {
+         lexsim_p->get_sims(s1tokens, hyptokens, mode, out);
       }
 
-      std::pair<double, double> ngram(std::vector<std::string>& s1tokens,
-                                      std::vector<std::string>& hyptokens,
-                                      std::vector<std::vector<double> > s1embs,
-                                      std::vector<std::vector<double> > hypembs,
-                                      int mode) {
-         //std::cerr<<"ng: " << s1tokens.size()<<std::endl;
-         //std::cerr<<"ng: " << hyptokens.size()<<std::endl;
-         if (s1tokens.size() != hyptokens.size()) {
-            std::cerr << "ERROR: Failed to compute n-gram similarity - "
-               << "s1 n-gram size != hyp n-gram size. Exiting..." << std::endl;
-            exit(1);
-         }
-         double presult = 0.0;
-         double rresult = 0.0;
-         double plen = 0.0;
-         double rlen = 0.0;
-         for (size_t i = 0; i < s1tokens.size(); i++) {
-            double rw = 0.0;
-            double pw = 0.0;
-            double ls = 0.0;
+      // out[i * hypembs.size() + j] is the similarity of s1embs[i] and hypembs[j]
+      void get_sims(const matview_t& s1embs, const matview_t& hypembs,
+                    std::vector<double>& out) {
+         lexsim_p->get_sims(s1embs, hypembs, out);
+      }
+
+      // n-gram weighted precision and recall reading the token similarities
+      // from sims, sims[i * stride + j] for s1tokens[i] and hyptokens[j]
+      std::pair<double, double> nwpr(std::vector<tokid_type>& s1tokens,
+                                     std::vector<tokid_type>& hyptokens,
+                                     const double* sims, size_t stride, int mode) {
+         size_t m = s1tokens.size();
+         size_t h = hyptokens.size();
+         size_t n = n_m;
+         if ((int)m < n_m || (int)h < n_m) {
+            n = std::min(m, h);
+         }
+         // weights of the tokens within an n-gram pair (rw, pw) and of the
+         // n-grams themselves (lw)
+         std::vector<double> rw(m, 0.0);
+         std::vector<double> lw(m);
+         std::vector<double> pw(h);
+         for (size_t i = 0; i < m; i++) {
             if (mode == yisi::INP_MODE) {
-               rw = (*inplexweight_p)(s1tokens[i]);
+               rw[i] = (*inplexweight_p)(s1tokens[i]);
             } else if (mode == yisi::REF_MODE) {
-               rw = (*reflexweight_p)(s1tokens[i]);
+               rw[i] = (*reflexweight_p)(s1tokens[i]);
             }
-            pw = (*hyplexweight_p)(hyptokens[i]);
-            //std::cerr << s1tokens[i] << " ||| " << hyptokens[i];
-            ls = lexsim_p->get_sim(s1embs[i], hypembs[i]);
-            //std::cerr << ls << std::endl;
-            rresult += rw * ls;
-            presult += pw * ls;
-            rlen += rw;
-            plen += pw;
-         }
-         std::pair<double, double> result = std::make_pair(presult / plen, rresult / rlen);
-         return result;
-      }
-
-      double ngramlw(std::vector<std::string>& tokens, int mode) {
-         double result = 0.0;
-         for (auto it = tokens.begin(); it != tokens.end(); it++) {
             if (mode == yisi::REF_MODE) {
-               result += (*reflexweight_p)(*it);
+               lw[i] = (*reflexweight_p)(s1tokens[i]);
             } else if (mode == yisi::HYP_MODE) {
-               result += (*hyplexweight_p)(*it);
+               lw[i] = (*hyplexweight_p)(s1tokens[i]);
             } else {
-               result += (*inplexweight_p)(*it);
+               lw[i] = (*inplexweight_p)(s1tokens[i]);
+            }
+         }
+         for (size_t j = 0; j < h; j++) {
+            pw[j] = (*hyplexweight_p)(hyptokens[j]);
+         }
+
+         // weights of the s1 and hyp n-grams within the n-gram pairs (rlen,
+         // plen) and of the s1 n-grams themselves (lwin)
+         size_t s1n = m - n + 1;
+         size_t hypn = h - n + 1;
+         std::vector<double> rlen(s1n, 0.0);
+         std::vector<double> lwin(s1n, 0.0);
+         std::vector<double> plen(hypn, 0.0);
+         for (size_t ii = 0; ii < s1n; ii++) {
+            for (size_t k = 0; k < n; k++) {
+               rlen[ii] += rw[ii + k];
+               lwin[ii] += lw[ii + k];
+            }
+         }
+         for (size_t jj = 0; jj < hypn; jj++) {
+            for (size_t k = 0; k < n; k++) {
+               plen[jj] += pw[jj + k];
             }
          }
-         return result;
-      }
-
-      std::pair<double, double> nwpr(std::vector<std::string>& s1tokens,
-                                     std::vector<std::string>& hyptokens, int mode) {
-         std::vector<std::vector<std::string> > s1ngrams;
-         std::vector<std::vector<std::string> > hypngrams;
 
-         if ((int)s1tokens.size() < n_m || (int)hyptokens.size() < n_m) {
-            s1ngrams = yisi::collect_ngram(std::min(s1tokens.size(), hyptokens.size()), s1tokens);
-            hypngrams = yisi::collect_ngram(std::min(s1tokens.size(), hyptokens.size()), hyptokens);
-         } else {
-            s1ngrams = yisi::collect_ngram(n_m, s1tokens);
-            hypngrams = yisi::collect_ngram(n_m, hyptokens);
+         // While no similarity exceeds 1.0 and no weight is negative, no
+         // window scores above 1.0 despite the rounding, so an n-gram that
+         // reached 1.0 is done with
+         bool bounded = true;
+         for (size_t i = 0; i < m; i++) {
+            bounded = bounded && rw[i] >= 0.0;
+            for (size_t j = 0; j < h; j++) {
+               bounded = bounded && sims[i * stride + j] <= 1.0;
+            }
+         }
+         for (size_t j = 0; j < h; j++) {
+            bounded = bounded && pw[j] >= 0.0;
+         }
+         double bound = bounded ? 1.0 : std::numeric_limits<double>::infinity();
+
+         // The weighted similarities are summed along the diagonals of sims:
+         // entry (i + 1, j + 1) adds the token pair (i, j) to entry (i, j), so
+         // the sums of a window are the difference of two entries, in O(m*h)
+         // for all the windows; rabs and pabs sum the magnitudes, to bound
+         // the rounding of the differences.
+         size_t w = h + 1;
+         std::vector<double> rsum((m + 1) * w, 0.0);
+         std::vector<double> psum((m + 1) * w, 0.0);
+         std::vector<double> rabs((m + 1) * w, 0.0);
+         std::vector<double> pabs((m + 1) * w, 0.0);
+         for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < h; j++) {
+               double ls = sims[i * stride + j];
+               size_t c = (i + 1) * w + j + 1;
+               size_t b = i * w + j;
+               rsum[c] = rsum[b] + rw[i] * ls;
+               psum[c] = psum[b] + pw[j] * ls;
+               rabs[c] = rabs[b] + std::fabs(rw[i] * ls);
+               pabs[c] = pabs[b] + std::fabs(pw[j] * ls);
+            }
          }
-         double nom = 0.0;
-         double denom = 0.0;
 
-         for (size_t ii = 0; ii < s1ngrams.size(); ii++) {
-            double sim = 0.0;
-            double rw = ngramlw(s1ngrams[ii], mode);
+         // best recall of each s1 n-gram and best precision of each hyp n-gram
+         std::vector<double> rbest(s1n, 0.0);
+         std::vector<double> pbest(hypn, 0.0);
+         // The bests keep the sums taken token by token, so that the scores
+         // do not depend on the summation order; a window is summed that way
+         // only when its prefix-sum estimate, widened by the worst rounding of
+         // both sums, may raise either best, which leaves O(n) per window for
+         // the running maxima and the near ties only.
+         auto score = [&](size_t ii, size_t jj) {
+            double rresult = 0.0;
+            double presult = 0.0;
+            for (size_t k = 0; k < n; k++) {
+               double ls = sims[(ii + k) * stride + jj + k];
+               rresult += rw[ii + k] * ls;
+               presult += pw[jj + k] * ls;
+            }
+            rbest[ii] = std::fmax(rbest[ii], rresult / rlen[ii]);
+            pbest[jj] = std::fmax(pbest[jj], presult / plen[jj]);
+         };
+         auto improves = [&](size_t ii, size_t jj) {
+            if (!(rlen[ii] > 0.0 && plen[jj] > 0.0)) {
+               return true;
+            }
+            size_t c = (ii + n) * w + jj + n;
+            size_t b = ii * w + jj;
+            double eps = 2.0 * (std::min(ii, jj) + 2 * n + 4) * std::numeric_limits<double>::epsilon();
+            double r = (rsum[c] - rsum[b]) / rlen[ii];
+            double p = (psum[c] - psum[b]) / plen[jj];
+            r += eps * ((rabs[c] + rabs[b]) / rlen[ii] + std::fabs(r));
+            p += eps * ((pabs[c] + pabs[b]) / plen[jj] + std::fabs(p));
+            return !(r <= rbest[ii] && p <= pbest[jj]);
+         };
+
+         // identical n-grams are scored first through a hash index of the hyp
+         // n-grams, so that common exact matches settle their n-grams at once
+         auto ngram_hash = [n](const std::vector<tokid_type>& tokens, size_t start) {
+            uint64_t result = 0;
+            for (size_t k = 0; k < n; k++) {
+               result = mix_hash(result ^ tokens[start + k]);
+            }
+            return result;
+         };
+         std::unordered_multimap<uint64_t, size_t> hypindex;
+         for (size_t jj = 0; jj < hypn; jj++) {
+            hypindex.insert(std::make_pair(ngram_hash(hyptokens, jj), jj));
+         }
+         for (size_t ii = 0; ii < s1n; ii++) {
+            auto range = hypindex.equal_range(ngram_hash(s1tokens, ii));
+            for (auto it = range.first; it != range.second; it++) {
+               if (std::equal(s1tokens.begin() + ii, s1tokens.begin() + ii + n,
+                              hyptokens.begin() + it->second)) {
+                  score(ii, it->second);
+               }
+            }
+         }
 
-            for (size_t jj = 0; jj < hypngrams.size(); jj++) {
-               sim = std::fmax(sim, ngram(s1ngrams[ii], hypngrams[jj], mode).second);
+         // the remaining pairs, skipping those whose n-grams are both done;
+         // open lists the hyp n-grams still below the bound
+         std::vector<size_t> open;
+         for (size_t jj = 0; jj < hypn; jj++) {
+            if (!(pbest[jj] >= bound)) {
+               open.push_back(jj);
             }
-            nom += rw * sim;
-            denom += rw;
          }
-         double recall = nom / denom;
-         nom = 0.0;
-         denom = 0.0;
-         for (size_t iii = 0; iii < hypngrams.size(); iii++) {
-            double hs = 0.0;
-            double hw = ngramlw(hypngrams[iii], yisi::HYP_MODE);
-            for (size_t jjj = 0; jjj < s1ngrams.size(); jjj++) {
-               hs = std::fmax(hs, ngram(s1ngrams[jjj], hypngrams[iii], mode).first);
+         for (size_t ii = 0; ii < s1n; ii++) {
+            if (!(rbest[ii] >= bound)) {
+               for (size_t jj = 0; jj < hypn; jj++) {
+                  if (!(rbest[ii] >= bound && pbest[jj] >= bound) && improves(ii, jj)) {
+                     score(ii, jj);
+                  }
+               }
+            } else {
+               for (auto it = open.begin(); it != open.end(); it++) {
+                  if (improves(ii, *it)) {
+                     score(ii, *it);
+                  }
+               }
             }
-            nom += hw * hs;
-            denom += hw;
+            size_t k = 0;
+            for (size_t o = 0; o < open.size(); o++) {
+               if (!(pbest[open[o]] >= bound)) {
+                  open[k++] = open[o];
+               }
+            }
+            open.resize(k);
          }
-         double precision = nom / denom;
-         std::pair<double, double> result = std::make_pair(precision, recall);
-         return result;
-      }
 
-      std::pair<double, double> nwpr(std::vector<std::string>& s1tokens,
-                                     std::vector<std::string>& hyptokens,
-                                     std::vector<std::vector<double> > s1embs,
-                                     std::vector<std::vector<double> > hypembs,
-                                     int mode) {
-         std::vector<std::vector<std::string> > s1ngrams;
-         std::vector<std::vector<std::string> > hypngrams;
-         std::vector<std::vector<std::vector<double> > > s1embngrams;
-         std::vector<std::vector<std::vector<double> > > hypembngrams;
-
-         if ((int)s1tokens.size() < n_m || (int)hyptokens.size() < n_m) {
-            s1ngrams = yisi::collect_ngram(std::min(s1tokens.size(), hyptokens.size()), s1tokens);
-            hypngrams = yisi::collect_ngram(std::min(s1tokens.size(), hyptokens.size()), hyptokens);
-            s1embngrams = yisi::collect_ngram(std::min(s1tokens.size(), hyptokens.size()), s1embs);
-            hypembngrams = yisi::collect_ngram(std::min(s1tokens.size(), hyptokens.size()), hypembs);
-         } else {
-            s1ngrams = yisi::collect_ngram(n_m, s1tokens);
-            hypngrams = yisi::collect_ngram(n_m, hyptokens);
-            s1embngrams = yisi::collect_ngram(n_m, s1embs);
-            hypembngrams = yisi::collect_ngram(n_m, hypembs);
-         }
          double nom = 0.0;
          double denom = 0.0;
-
-         for (size_t ii = 0; ii < s1ngrams.size(); ii++) {
-            double sim = 0.0;
-            double rw = ngramlw(s1ngrams[ii], mode);
-
-            for (size_t jj = 0; jj < hypngrams.size(); jj++) {
-               sim = std::fmax(sim, ngram(s1ngrams[ii], hypngrams[jj], s1embngrams[ii], hypembngrams[jj], mode).second);
-            }
-            nom += rw * sim;
-            denom += rw;
+         for (size_t ii = 0; ii < s1n; ii++) {
+            nom += lwin[ii] * rbest[ii];
+            denom += lwin[ii];
          }
          double recall = nom / denom;
          nom = 0.0;
          denom = 0.0;
-         for (size_t iii = 0; iii < hypngrams.size(); iii++) {
-            double hs = 0.0;
-            double hw = ngramlw(hypngrams[iii], yisi::HYP_MODE);
-            for (size_t jjj = 0; jjj < s1ngrams.size(); jjj++) {
-               hs = std::fmax(hs, ngram(s1ngrams[jjj], hypngrams[iii], s1embngrams[jjj], hypembngrams[iii], mode).first);
-            }
-            nom += hw * hs;
-            denom += hw;
+         for (size_t jj = 0; jj < hypn; jj++) {
+            nom += plen[jj] * pbest[jj];
+            denom += plen[jj];
          }
          double precision = nom / denom;
          std::pair<double, double> result = std::make_pair(precision, recall);
@@ -554,7 +600,115 @@ namespace yisi {
          return result;
       }
 
+      // looks up the rows and weights of all the interned tokens, so that the
+      // concurrent alignments only read them
+      void prepare(bool inp) {
+         lexsim_p->prepare(inp);
+         reflexweight_p->prepare();
+         hyplexweight_p->prepare();
+         if (inp && inplexweight_name_m != "") {
+            inplexweight_p->prepare();
+         }
+      }
+
+      // warm-starts the phrasesim cache from readcache-path, if any
+      void readcache() {
+         if (readcache_path_m == "") {
+            return;
+         }
+         std::cerr << "Reading similarity cache from " << readcache_path_m << " ... ";
+         std::ifstream is(readcache_path_m.c_str());
+         if (!is) {
+            std::cerr << "ERROR: Failed to open similarity cache file. Exiting..." << std::endl;
+            exit(1);
+         }
+         std::string magic;
+         std::getline(is, magic);
+         if (magic != "yisi-simcache 2") {
+            std::cerr << "ERROR: " << readcache_path_m << " is not a similarity cache file. Exiting..." << std::endl;
+            exit(1);
+         }
+
+         std::string section;
+         std::string digest;
+         size_t n = 0;
+         is >> section >> digest >> n;
+         is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+         if (section != "phrasesim") {
+            std::cerr << "ERROR: Malformed similarity cache file (no phrasesim section). Exiting..." << std::endl;
+            exit(1);
+         }
+         bool match = (digest == yisi::digest_fingerprint(fingerprint_m));
+         for (size_t i = 0; match && i < n; i++) {
+            std::string line;
+            std::getline(is, line);
+            auto fields = yisi::tokenize(line, '\t', true);
+            if (fields.size() != 5) {
+               std::cerr << "ERROR: Malformed similarity cache entry (" << line << "). Exiting..." << std::endl;
+               exit(1);
+            }
+            phrasesimkey_t key;
+            key.ns_m = cachens_m;
+            key.mode_m = atoi(fields[0].c_str());
+            key.s1_m = yisi::intern(yisi::tokenize(fields[1]));
+            key.hyp_m = yisi::intern(yisi::tokenize(fields[2]));
+            get_phrasesimcache().put(key, std::make_pair(strtod(fields[3].c_str(), NULL),
+                                                         strtod(fields[4].c_str(), NULL)));
+         }
+         if (!match) {
+            std::cerr << "phrasesim entries are from another model; skipped ... ";
+         }
+         std::cerr << "Done." << std::endl;
+      }
+
+      // saves the entries of this model in the phrasesim cache to writecache-path, if any
+      void writecache() {
+         if (writecache_path_m == "") {
+            return;
+         }
+         std::cerr << "Writing similarity cache to " << writecache_path_m << " ... ";
+         std::ofstream os;
+         yisi::open_ofstream(os, writecache_path_m);
+         os.precision(17);
+         os << "yisi-simcache 2" << std::endl;
+
+         const vocab_t& vocab = get_vocab();
+         std::vector<std::pair<phrasesimkey_t, std::pair<double, double> > > entries;
+         get_phrasesimcache().for_each([&](const phrasesimkey_t& key, const std::pair<double, double>& s) {
+            if (key.ns_m == cachens_m) {
+               entries.push_back(std::make_pair(key, s));
+            }
+         });
+         os << "phrasesim " << yisi::digest_fingerprint(fingerprint_m) << " " << entries.size() << std::endl;
+         for (auto it = entries.begin(); it != entries.end(); it++) {
+            os << it->first.mode_m << "\t";
+            for (size_t i = 0; i < it->first.s1_m.size(); i++) {
+               os << (i > 0 ? " " : "") << vocab.get_token(it->first.s1_m[i]);
+            }
+            os << "\t";
+            for (size_t i = 0; i < it->first.hyp_m.size(); i++) {
+               os << (i > 0 ? " " : "") << vocab.get_token(it->first.hyp_m[i]);
+            }
+            os << "\t" << it->second.first << "\t" << it->second.second << std::endl;
+         }
+         os.close();
+         std::cerr << "Done." << std::endl;
+      }
+
    private:
+      // the key is reused by the thread's next lookup, so that its storage
+      // is only allocated while growing and a cache hit does not allocate
+      const phrasesimkey_t& get_cachekey(std::vector<tokid_type>& s1tokens,
+                                         std::vector<tokid_type>& hyptokens, int mode) {
+         static thread_local phrasesimkey_t key;
+         // ref and hyp mode queries share their entries
+         key.ns_m = cachens_m;
+         key.mode_m = (mode == yisi::INP_MODE) ? yisi::INP_MODE : yisi::REF_MODE;
+         key.s1_m.assign(s1tokens.begin(), s1tokens.end());
+         key.hyp_m.assign(hyptokens.begin(), hyptokens.end());
+         return key;
+      }
+
       lexsim_t* lexsim_p;
       lexweight_t* inplexweight_p;
       lexweight_t* reflexweight_p;
@@ -563,6 +717,10 @@ namespace yisi {
       std::string inplexweight_name_m;
       std::string phrasesim_name_m;
       int n_m;
+      std::string fingerprint_m;
+      uint32_t cachens_m;
+      std::string readcache_path_m;
+      std::string writecache_path_m;
    }; // class phrasesim_t
 
 } // yisi
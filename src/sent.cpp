@@ -36,7 +36,11 @@ sent_t::sent_t(const sent_t& rhs) {
    sent_type_m = rhs.sent_type_m;
    token_m = rhs.token_m;
    unit_m = rhs.unit_m;
+   tokenid_m = rhs.tokenid_m;
+   unitid_m = rhs.unitid_m;
    emb_m = rhs.emb_m;
+   emboffset_m = rhs.emboffset_m;
+   emblen_m = rhs.emblen_m;
    tid2uspan_m = rhs.tid2uspan_m;
    uid2tid_m = rhs.uid2tid_m;
 }
@@ -45,7 +49,11 @@ void sent_t::operator=(const sent_t& rhs) {
    sent_type_m = rhs.sent_type_m;
    token_m = rhs.token_m;
    unit_m = rhs.unit_m;
+   tokenid_m = rhs.tokenid_m;
+   unitid_m = rhs.unitid_m;
    emb_m = rhs.emb_m;
+   emboffset_m = rhs.emboffset_m;
+   emblen_m = rhs.emblen_m;
    tid2uspan_m = rhs.tid2uspan_m;
    uid2tid_m = rhs.uid2tid_m;
 }
@@ -90,13 +98,26 @@ vector<string> sent_t::get_units(span_type uspan) {
    return result;
 }
 
-vector<vector<double> > sent_t::get_embs(span_type uspan) {
-   if (sent_type_m == "uemb") {
-      vector<vector<double> > result;
+vector<tokid_type> sent_t::get_unitids(span_type uspan) {
+   vector<tokid_type> result;
+   if (sent_type_m == "word") {
       for (size_t i = uspan.first; i < uspan.second; i++) {
-         result.push_back(emb_m[i]);
+         result.push_back(tokenid_m[i]);
       }
-      return result;
+   } else {
+      for (size_t i = uspan.first; i < uspan.second; i++) {
+         if (i < unitid_m.size()) {
+            result.push_back(unitid_m[i]);
+         }
+      }
+   }
+   return result;
+}
+
+matview_t sent_t::get_embs(span_type uspan) {
+   if (sent_type_m == "uemb") {
+      return matview_t(emb_m.data(), emboffset_m.data() + uspan.first,
+                       emblen_m.data() + uspan.first, uspan.second - uspan.first);
    } else {
       cerr << "ERROR: sentence type (" << sent_type_m << ") "
            << "does not provide contextual embeddings. Exiting..." << endl;
@@ -127,6 +148,7 @@ sent_t::span_type sent_t::uspan2tspan(span_type uspan) {
 
 void sent_t::set_tokens(vector<string> t) {
    token_m = t;
+   tokenid_m = intern(t);
    /*
    cerr << "In set_tokens(t): ";
    for (auto it = token_m.begin(); it != token_m.end(); it++) {
@@ -138,10 +160,13 @@ void sent_t::set_tokens(vector<string> t) {
 
 void sent_t::set_units(vector<string> u ) {
    unit_m = u;
+   unitid_m = intern(u);
 }
 
-void sent_t::set_embs(vector<vector<double> > e) {
-   emb_m = e;
+void sent_t::set_embs(vector<float>& data, vector<size_t>& offsets, vector<double>& lens) {
+   emb_m.swap(data);
+   emboffset_m.swap(offsets);
+   emblen_m.swap(lens);
 }
 
 void sent_t::set_tid2uspan(vector<span_type> t2u) {
@@ -156,9 +181,19 @@ size_t sent_t::get_token_size() {
    return token_m.size();
 }
 
+size_t sent_t::get_unit_size() {
+   if (sent_type_m == "word") {
+      return tokenid_m.size();
+   } else {
+      return unitid_m.size();
+   }
+}
+
 vector<sent_t*> yisi::read_sent(string sent_type, string token_path, string unit_path, string idemb_path) {
    vector<sent_t*> result;
-   vector<vector<double> > emb;
+   vector<float> emb;
+   vector<size_t> emboffset(1, 0);
+   vector<double> emblen;
    vector<sent_t::span_type> t2u;
    vector<size_t> u2t;
    size_t currtid = (size_t)-1;
@@ -197,7 +232,7 @@ vector<sent_t*> yisi::read_sent(string sent_type, string token_path, string unit
             s->set_units(units);
             //cerr << " #unit=" << units.size();
             if (sent_type == "uemb") {
-               s->set_embs(emb);
+               s->set_embs(emb, emboffset, emblen);
             }
             //cerr << " #emb=" << emb.size() << " #dim=" << emb[0].size();
             s->set_tid2uspan(t2u);
@@ -209,6 +244,8 @@ vector<sent_t*> yisi::read_sent(string sent_type, string token_path, string unit
             tt++;
             ut++;
             emb.clear();
+            emboffset.assign(1, 0);
+            emblen.clear();
             t2u.clear();
             u2t.clear();
             currtid = (size_t)-1;
@@ -225,19 +262,18 @@ vector<sent_t*> yisi::read_sent(string sent_type, string token_path, string unit
                t2u.back().second=uid+1;
             }
             if (sent_type == "uemb") {
-               vector<double> e;
+               // kept as read, like the rows of an embedding table; the
+               // length normalizes them in the similarity kernels
                double len = 0.0;
                double v;
                while (!iss.eof()) {
                   iss >> v;
-                  e.push_back(v);
-                  len += v*v;
-               }
-               len = sqrt(len);
-               for (size_t i = 0; i < e.size(); i++) {
-                  e[i] /= len;
+                  float f = (float)v;
+                  emb.push_back(f);
+                  len += (double)f * f;
                }
-               emb.push_back(e);
+               emboffset.push_back(emb.size());
+               emblen.push_back(sqrt(len));
             }
          }
          fin.peek();
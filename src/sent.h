@@ -18,7 +18,9 @@
 #ifndef SENT_H
 #define SENT_H
 
+#include "embview.h"
 #include "util.h"
+#include "vocab.h"
 
 #include <utility>
 #include <string>
@@ -40,20 +42,31 @@ namespace yisi {
       std::vector<std::string> get_tokens(span_type tspan);
       std::vector<std::string> get_tokens();
       std::vector<std::string> get_units(span_type uspan);
-      std::vector<std::vector<double> > get_embs(span_type uspan);
+      std::vector<tokid_type> get_unitids(span_type uspan);
+      // views the embeddings of the units in uspan, stored by the sentence
+      matview_t get_embs(span_type uspan);
       void set_tokens(std::vector<std::string> t);
       void set_units(std::vector<std::string> u);
-      void set_embs(std::vector<std::vector<double> > e);
+      // takes over the embeddings stored back to back in data, the i-th one
+      // from offsets[i] to offsets[i + 1] and of length lens[i]
+      void set_embs(std::vector<float>& data, std::vector<size_t>& offsets,
+                    std::vector<double>& lens);
       void set_tid2uspan(std::vector<span_type> t2u);
       void set_uid2tid(std::vector<size_t> u2t);
       span_type tspan2uspan(span_type tspan);
       span_type uspan2tspan(span_type uspan);
       size_t get_token_size();
+      // number of units, the tokens of a word sentence
+      size_t get_unit_size();
    private:
       std::string sent_type_m;
       std::vector<std::string> token_m;
       std::vector<std::string> unit_m;
-      std::vector<std::vector<double> > emb_m;
+      std::vector<tokid_type> tokenid_m;
+      std::vector<tokid_type> unitid_m;
+      std::vector<float> emb_m;
+      std::vector<size_t> emboffset_m;
+      std::vector<double> emblen_m;
       std::vector<span_type> tid2uspan_m;
       std::vector<size_t> uid2tid_m;
    }; // class sent_t
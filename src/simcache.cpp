@@ -0,0 +1,77 @@
+/**
+ * @file simcache.cpp
+ * @brief Similarity cache
+ *
+ * @author agent
+ *
+ * Definition of the process-wide phrasesim cache.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "simcache.h"
+#include "embtable.h"
+#include "util.h"
+
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+
+using namespace yisi;
+using namespace std;
+
+namespace {
+   const size_t DEFAULT_SIMCACHE_MB = 1024;
+} // anonymous namespace
+
+phrasesimcache_type& yisi::get_phrasesimcache() {
+   static phrasesimcache_type cache(DEFAULT_SIMCACHE_MB * 1024 * 1024);
+   return cache;
+}
+
+uint32_t yisi::get_cachens(string fingerprint) {
+   static mutex ns_mutex;
+   static map<string, uint32_t> ns;
+   lock_guard<mutex> lock(ns_mutex);
+   auto it = ns.find(fingerprint);
+   if (it != ns.end()) {
+      return it->second;
+   }
+   uint32_t result = (uint32_t)ns.size();
+   ns[fingerprint] = result;
+   return result;
+}
+
+void yisi::set_simcache_budget(size_t mb) {
+   get_phrasesimcache().set_budget(mb * 1024 * 1024);
+}
+
+void yisi::print_simcache_stats(ostream& os) {
+   phrasesimcache_type& pc = get_phrasesimcache();
+   os << "Phrasesim cache: " << pc.get_hits() << " hits, " << pc.get_misses() << " misses, "
+      << pc.size() << " entries (" << pc.get_bytes() / 1024 << " KB)" << endl;
+}
+
+string yisi::get_file_stamp(string paths) {
+   ostringstream result;
+   auto files = tokenize(paths, ':');
+   for (auto it = files.begin(); it != files.end(); it++) {
+      struct stat st;
+      if (stat(it->c_str(), &st) == 0) {
+         result << "\t" << st.st_size << ":" << st.st_mtime;
+      } else {
+         result << "\t-";
+      }
+   }
+   return result.str();
+}
+
+string yisi::digest_fingerprint(string fingerprint) {
+   ostringstream result;
+   result << hex << hash_word(fingerprint.data(), fingerprint.size());
+   return result.str();
+}
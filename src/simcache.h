@@ -0,0 +1,210 @@
+/**
+ * @file simcache.h
+ * @brief Similarity cache
+ *
+ * @author agent
+ *
+ * Class definition of:
+ *    - simcache_t (sharded, memory-bounded LRU cache safe for concurrent use)
+ *    - phrasesimkey_t (key of a phrasal similarity)
+ * and the declaration of the process-wide phrasesim cache.
+ *
+ * Keys carry the namespace of the model that computed the value, so that
+ * models with different settings in one process never share entries.
+ * Lexical similarities are not cached: those of a sentence pair are
+ * computed at once, which is cheaper than looking them up pair by pair.
+ *
+ * A cache file (see phrasesim_t::writecache) holds a phrasesim section,
+ * headed by the digest of the fingerprint of the models that computed it;
+ * tokens are written out since ids only hold within a process, and values
+ * with 17 digits so that they read back exactly.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef SIMCACHE_H
+#define SIMCACHE_H
+
+#include "vocab.h"
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace yisi {
+
+   inline uint64_t mix_hash(uint64_t h) {
+      // finalizer of MurmurHash3
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h;
+   }
+
+   struct phrasesimkey_t {
+      uint32_t ns_m;
+      int mode_m;
+      std::vector<tokid_type> s1_m;
+      std::vector<tokid_type> hyp_m;
+      bool operator==(const phrasesimkey_t& rhs) const {
+         return ns_m == rhs.ns_m && mode_m == rhs.mode_m && s1_m == rhs.s1_m && hyp_m == rhs.hyp_m;
+      }
+   }; // struct phrasesimkey_t
+
+   struct phrasesimkey_hash {
+      size_t operator()(const phrasesimkey_t& key) const {
+         uint64_t h = mix_hash(((uint64_t)key.ns_m << 8) | (uint64_t)key.mode_m);
+         for (auto it = key.s1_m.begin(); it != key.s1_m.end(); it++) {
+            h = mix_hash(h ^ *it);
+         }
+         h = mix_hash(h ^ 0xffffffffULL);
+         for (auto it = key.hyp_m.begin(); it != key.hyp_m.end(); it++) {
+            h = mix_hash(h ^ *it);
+         }
+         return h;
+      }
+   }; // struct phrasesimkey_hash
+
+   inline size_t get_heap_bytes(const phrasesimkey_t& key) {
+      return (key.s1_m.capacity() + key.hyp_m.capacity()) * sizeof(tokid_type);
+   }
+
+   template <class key_T, class value_T, class hash_T>
+   class simcache_t {
+   public:
+      typedef key_T key_type;
+      typedef value_T value_type;
+
+      // budget in bytes; 0 = unbounded
+      simcache_t(size_t budget = 0) : budget_m(budget), hits_m(0), misses_m(0) {}
+
+      bool get(const key_T& key, value_T& value) {
+         shard_t& shard = get_shard(key);
+         std::lock_guard<std::mutex> lock(shard.mutex_m);
+         auto it = shard.map_m.find(key);
+         if (it == shard.map_m.end()) {
+            misses_m++;
+            return false;
+         }
+         shard.lru_m.splice(shard.lru_m.begin(), shard.lru_m, it->second.lru_m);
+         value = it->second.value_m;
+         hits_m++;
+         return true;
+      }
+
+      void put(const key_T& key, const value_T& value) {
+         shard_t& shard = get_shard(key);
+         std::lock_guard<std::mutex> lock(shard.mutex_m);
+         auto res = shard.map_m.insert(std::make_pair(key, entry_t()));
+         res.first->second.value_m = value;
+         if (!res.second) {
+            shard.lru_m.splice(shard.lru_m.begin(), shard.lru_m, res.first->second.lru_m);
+            return;
+         }
+         shard.lru_m.push_front(&(res.first->first));
+         res.first->second.lru_m = shard.lru_m.begin();
+         shard.bytes_m += get_entry_bytes(key);
+         size_t shard_budget = budget_m / NSHARDS;
+         while (budget_m > 0 && shard.bytes_m > shard_budget && shard.lru_m.size() > 1) {
+            auto victim = shard.map_m.find(*shard.lru_m.back());
+            shard.bytes_m -= get_entry_bytes(victim->first);
+            shard.lru_m.pop_back();
+            shard.map_m.erase(victim);
+         }
+      }
+
+      // visits all entries; not to be called while other threads use the cache
+      template <class F> void for_each(F f) {
+         for (size_t i = 0; i < NSHARDS; i++) {
+            for (auto it = shards_m[i].map_m.begin(); it != shards_m[i].map_m.end(); it++) {
+               f(it->first, it->second.value_m);
+            }
+         }
+      }
+
+      void set_budget(size_t budget) { budget_m = budget; }
+      size_t get_budget() const { return budget_m; }
+      size_t get_hits() const { return hits_m; }
+      size_t get_misses() const { return misses_m; }
+
+      size_t size() {
+         size_t result = 0;
+         for (size_t i = 0; i < NSHARDS; i++) {
+            std::lock_guard<std::mutex> lock(shards_m[i].mutex_m);
+            result += shards_m[i].map_m.size();
+         }
+         return result;
+      }
+
+      size_t get_bytes() {
+         size_t result = 0;
+         for (size_t i = 0; i < NSHARDS; i++) {
+            std::lock_guard<std::mutex> lock(shards_m[i].mutex_m);
+            result += shards_m[i].bytes_m;
+         }
+         return result;
+      }
+
+   private:
+      static const size_t NSHARDS = 64;
+
+      struct entry_t {
+         value_T value_m;
+         typename std::list<const key_T*>::iterator lru_m;
+      };
+
+      struct shard_t {
+         shard_t() : bytes_m(0) {}
+         std::mutex mutex_m;
+         std::unordered_map<key_T, entry_t, hash_T> map_m;
+         // most recently used first; points to the keys held by map_m
+         std::list<const key_T*> lru_m;
+         size_t bytes_m;
+      };
+
+      shard_t& get_shard(const key_T& key) {
+         return shards_m[mix_hash(hash_T()(key)) >> 58];
+      }
+
+      static size_t get_entry_bytes(const key_T& key) {
+         // hash node, bucket and lru node overheads included
+         return sizeof(key_T) + sizeof(entry_t) + 6 * sizeof(void*) + get_heap_bytes(key);
+      }
+
+      simcache_t(const simcache_t&);
+      simcache_t& operator=(const simcache_t&);
+
+      shard_t shards_m[NSHARDS];
+      size_t budget_m;
+      std::atomic<size_t> hits_m;
+      std::atomic<size_t> misses_m;
+   }; // class simcache_t
+
+   typedef simcache_t<phrasesimkey_t, std::pair<double, double>, phrasesimkey_hash> phrasesimcache_type;
+
+   phrasesimcache_type& get_phrasesimcache();
+   // namespace id of the model described by fingerprint
+   uint32_t get_cachens(std::string fingerprint);
+   // budget in MB of the phrasesim cache; 0 = unbounded
+   void set_simcache_budget(size_t mb);
+   void print_simcache_stats(std::ostream& os);
+   // size and modification time of each of the ':'-separated files
+   std::string get_file_stamp(std::string paths);
+   // short hexadecimal digest of a model fingerprint, for the cache files
+   std::string digest_fingerprint(std::string fingerprint);
+
+} // yisi
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file simcache_test.cpp
+ * @brief Unit test for simcache.
+ *
+ * @author agent
+ *
+ * Fills a small cache well past its budget from several threads and checks
+ * that it stays within the budget, keeps the most recent entries and counts
+ * its hits and misses.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "simcache.h"
+#include "util.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace yisi;
+
+namespace {
+   phrasesimkey_t make_key(uint32_t ns, tokid_type s1, tokid_type hyp) {
+      phrasesimkey_t result;
+      result.ns_m = ns;
+      result.mode_m = REF_MODE;
+      result.s1_m = vector<tokid_type>{s1};
+      result.hyp_m = vector<tokid_type>{hyp};
+      return result;
+   }
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+   const size_t budget = 256 * 1024;
+   const tokid_type n = 100000;
+   phrasesimcache_type cache(budget);
+
+   vector<thread> threads;
+   for (tokid_type t = 0; t < 4; t++) {
+      threads.push_back(thread([&cache, t, n]() {
+         for (tokid_type i = t; i < n; i += 4) {
+            cache.put(make_key(0, i, i + 1), make_pair(i * 0.5, i * 0.25));
+         }
+      }));
+   }
+   for (auto it = threads.begin(); it != threads.end(); it++) {
+      it->join();
+   }
+   cout << "within budget: " << (cache.get_bytes() <= budget ? "OK" : "FAILED") << endl;
+   cout << "evicted: " << (cache.size() < n ? "OK" : "FAILED") << endl;
+
+   bool ok = true;
+   size_t found = 0;
+   for (tokid_type i = 0; i < n; i++) {
+      pair<double, double> v;
+      if (cache.get(make_key(0, i, i + 1), v)) {
+         found++;
+         ok = ok && (v.first == i * 0.5 && v.second == i * 0.25);
+      }
+   }
+   cout << "values: " << (ok ? "OK" : "FAILED") << endl;
+   cout << "counters: " << ((cache.get_hits() == found && cache.get_misses() == n - found) ? "OK" : "FAILED") << endl;
+
+   phrasesimkey_t last = make_key(0, n, n + 1);
+   phrasesimkey_t other = make_key(1, n, n + 1);
+   pair<double, double> v;
+   cache.put(last, make_pair(1.0, 1.0));
+   cout << "recent kept: " << (cache.get(last, v) ? "OK" : "FAILED") << endl;
+   cout << "namespaces: " << (!cache.get(other, v) ? "OK" : "FAILED") << endl;
+
+   phrasesimcache_type pcache;
+   phrasesimkey_t pkey;
+   pkey.ns_m = 0;
+   pkey.mode_m = INP_MODE;
+   pkey.s1_m = vector<tokid_type>{1, 2, 3};
+   pkey.hyp_m = vector<tokid_type>{4, 5};
+   pcache.put(pkey, make_pair(0.25, 0.75));
+   pair<double, double> p;
+   cout << "phrasesim: " << ((pcache.get(pkey, p) && p.first == 0.25 && p.second == 0.75) ? "OK" : "FAILED") << endl;
+   return 0;
+}
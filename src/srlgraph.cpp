@@ -18,13 +18,14 @@
 #include "srlgraph.h"
 #include "util.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
 using namespace yisi;
 using namespace std;
 
-srlgraph_t::srlgraph_t() {
+srlgraph_t::srlgraph_t() : sent_p(NULL), root_m(0) {
 }
 
 srlgraph_t::srlgraph_t(sent_t* sent) {
@@ -33,20 +34,6 @@ srlgraph_t::srlgraph_t(sent_t* sent) {
    sent_p = sent;
 }
 
-srlgraph_t::srlgraph_t(const srlgraph_t& rhs) {
-   srl_m = rhs.srl_m;
-   sent_p = rhs.sent_p;
-   root_m = rhs.root_m;
-   predof_m = predof_m;
-}
-
-void srlgraph_t::operator=(const srlgraph_t& rhs) {
-   srl_m = rhs.srl_m;
-   sent_p = rhs.sent_p;
-   root_m = rhs.root_m;
-   predof_m = predof_m;
-}
-
 srlgraph_t::srlnid_type srlgraph_t::new_root() {
    span_type span(0, 0);
    root_m = srl_m.new_node(span);
@@ -62,21 +49,22 @@ srlgraph_t::srlnid_type srlgraph_t::new_root(sent_t* sent) {
 
 srlgraph_t::srlnid_type srlgraph_t::new_pred() {
    span_type span(0, 0);
-   string label = "";
+   labelid_type label = get_labelvocab().intern("");
    srlnid_type predid = srl_m.new_node(span);
    srl_m.new_edge(predid, root_m, label);
    return predid;
 }
 
 srlgraph_t::srlnid_type srlgraph_t::new_pred(span_type& span, label_type& label) {
+   labelid_type labelid = get_labelvocab().intern(label);
    srlnid_type predid = srl_m.new_node(span);
-   srl_m.new_edge(predid, root_m, label);
+   srl_m.new_edge(predid, root_m, labelid);
    return predid;
 }
 
 srlgraph_t::srlnid_type srlgraph_t::new_arg(srlnid_type predid) {
    span_type span(0, 0);
-   string label = "";
+   labelid_type label = get_labelvocab().intern("");
    srlnid_type argid = srl_m.new_node(span);
    srl_m.new_edge(argid, predid, label);
    predof_m[argid] = predid;
@@ -85,39 +73,46 @@ srlgraph_t::srlnid_type srlgraph_t::new_arg(srlnid_type predid) {
 
 
 srlgraph_t::srlnid_type srlgraph_t::new_arg(srlnid_type predid, span_type& span, label_type& label) {
+   labelid_type labelid = get_labelvocab().intern(label);
    srlnid_type argid = srl_m.new_node(span);
-   srl_m.new_edge(argid, predid, label);
+   srl_m.new_edge(argid, predid, labelid);
    predof_m[argid] = predid;
    return argid;
 }
 
-srlgraph_t::srlnid_type srlgraph_t::get_root() {
+srlgraph_t::srlnid_type srlgraph_t::get_root() const {
    return root_m;
 }
 
-vector<srlgraph_t::srlnid_type> srlgraph_t::get_preds() {
+size_t srlgraph_t::get_node_count() const {
+   return srl_m.get_node_count();
+}
+
+vector<srlgraph_t::srlnid_type> srlgraph_t::get_preds() const {
    return get_args(root_m);
 }
 
-vector<srlgraph_t::srlnid_type> srlgraph_t::get_args(srlnid_type predid) {
+vector<srlgraph_t::srlnid_type> srlgraph_t::get_args(srlnid_type predid) const {
    vector<srlnid_type> args;
-   vector<srleid_type> arg_edges = srl_m.get_incoming_edges(predid);
-   for (vector<srleid_type>::iterator eit = arg_edges.begin(); eit != arg_edges.end(); eit++) {
+   const vector<srleid_type>& arg_edges = srl_m.get_incoming_edges(predid);
+   args.reserve(arg_edges.size());
+   for (vector<srleid_type>::const_iterator eit = arg_edges.begin(); eit != arg_edges.end(); eit++) {
       args.push_back(srl_m.get_edge_tail(*eit));
    }
    return args;
 }
 
-srlgraph_t::srlnid_type srlgraph_t::get_pred(srlnid_type argid) {
-   return predof_m[argid];
+srlgraph_t::srlnid_type srlgraph_t::get_pred(srlnid_type argid) const {
+   auto it = predof_m.find(argid);
+   return it == predof_m.end() ? srlnid_type() : it->second;
 }
 
 
-vector<string> srlgraph_t::get_sentence() {
+vector<string> srlgraph_t::get_sentence() const {
    return sent_p->get_tokens();
 }
 
-vector<string> srlgraph_t::get_role_filler_units(srlnid_type roleid) {
+vector<string> srlgraph_t::get_role_filler_units(srlnid_type roleid) const {
    //vector<string> fillers;
    span_type span = srl_m.get_node_data(roleid);
    //cerr<<span.first<<" "<<span.second;
@@ -133,20 +128,49 @@ vector<string> srlgraph_t::get_role_filler_units(srlnid_type roleid) {
    //return fillers;
 }
 
-vector<vector<double> > srlgraph_t::get_role_filler_embs(srlnid_type roleid) {
+vector<tokid_type> srlgraph_t::get_role_filler_unitids(srlnid_type roleid) const {
+   span_type span = srl_m.get_node_data(roleid);
+   return sent_p->get_unitids(sent_p->tspan2uspan(span));
+}
+
+matview_t srlgraph_t::get_role_filler_embs(srlnid_type roleid) const {
    span_type span = srl_m.get_node_data(roleid);
    return sent_p->get_embs(sent_p->tspan2uspan(span));
 }
 
-srlgraph_t::label_type srlgraph_t::get_role_label(srlnid_type roleid) {
+srlgraph_t::span_type srlgraph_t::get_role_uspan(srlnid_type roleid) const {
+   span_type result = sent_p->tspan2uspan(srl_m.get_node_data(roleid));
+   size_t n = sent_p->get_unit_size();
+   result.first = min(result.first, n);
+   result.second = max(result.first, min(result.second, n));
+   return result;
+}
+
+vector<tokid_type> srlgraph_t::get_unitids() const {
+   return sent_p->get_unitids(span_type(0, sent_p->get_unit_size()));
+}
+
+matview_t srlgraph_t::get_embs() const {
+   return sent_p->get_embs(span_type(0, sent_p->get_unit_size()));
+}
+
+size_t srlgraph_t::get_unit_size() const {
+   return sent_p->get_unit_size();
+}
+
+const srlgraph_t::label_type& srlgraph_t::get_role_label(srlnid_type roleid) const {
+   return get_labelvocab().get_token(get_role_labelid(roleid));
+}
+
+srlgraph_t::labelid_type srlgraph_t::get_role_labelid(srlnid_type roleid) const {
    return srl_m.get_edge_label(srl_m.get_outgoing_edges(roleid).at(0));
 }
 
-srlgraph_t::span_type srlgraph_t::get_role_span(srlnid_type roleid) {
+srlgraph_t::span_type srlgraph_t::get_role_span(srlnid_type roleid) const {
    return srl_m.get_node_data(roleid);
 }
 
-size_t srlgraph_t::get_sent_length() {
+size_t srlgraph_t::get_sent_length() const {
    return sent_p->get_token_size();
 }
 
@@ -170,7 +194,7 @@ void srlgraph_t::set_role_span(srlnid_type roleid, span_type& span) {
 }
 
 void srlgraph_t::set_role_label(srlnid_type roleid, label_type& label) {
-   srl_m.set_edge_label(srl_m.get_outgoing_edges(roleid).at(0), label);
+   srl_m.set_edge_label(srl_m.get_outgoing_edges(roleid).at(0), get_labelvocab().intern(label));
 } 
 
 void srlgraph_t::delete_sent() {
@@ -243,3 +267,8 @@ ostream& yisi::operator<<(ostream& os, srlgraph_t& srl) {
    return srl << os;
 }
 
+vocab_t& yisi::get_labelvocab() {
+   static vocab_t vocab;
+   return vocab;
+}
+
@@ -32,16 +32,21 @@ namespace yisi {
    public:
       typedef sent_t::span_type span_type;
       typedef std::string label_type;
-      typedef graph_t<span_type, label_type>::node_type srlnode_type;
-      typedef graph_t<span_type, label_type>::edge_type srledge_type;
-      typedef graph_t<span_type, label_type>::nid_type srlnid_type;
-      typedef graph_t<span_type, label_type>::eid_type srleid_type;
+      // id of a label in get_labelvocab()
+      typedef tokid_type labelid_type;
+      typedef graph_t<span_type, labelid_type>::node_type srlnode_type;
+      typedef graph_t<span_type, labelid_type>::edge_type srledge_type;
+      typedef graph_t<span_type, labelid_type>::nid_type srlnid_type;
+      typedef graph_t<span_type, labelid_type>::eid_type srleid_type;
 
 
       srlgraph_t();
       srlgraph_t(sent_t* sent);
-      srlgraph_t(const srlgraph_t& rhs);
-      void operator=(const srlgraph_t& rhs);
+      // the sentence is shared, not copied
+      srlgraph_t(const srlgraph_t& rhs) = default;
+      srlgraph_t(srlgraph_t&& rhs) = default;
+      srlgraph_t& operator=(const srlgraph_t& rhs) = default;
+      srlgraph_t& operator=(srlgraph_t&& rhs) = default;
 
       srlnid_type new_root();
       srlnid_type new_root(sent_t* sent);
@@ -50,20 +55,30 @@ namespace yisi {
       srlnid_type new_arg(srlnid_type predid);
       srlnid_type new_arg(srlnid_type predid, span_type& span, label_type& label);
 
-      srlnid_type get_root();
-      std::vector<srlnid_type> get_preds();
-      std::vector<srlnid_type> get_args(srlnid_type predid);
-
-      srlnid_type get_pred(srlnid_type argid);
-
-      std::vector<std::string> get_sentence();
-      std::vector<std::string> get_role_filler_units(srlnid_type roleid);
-      std::vector<std::vector<double> > get_role_filler_embs(srlnid_type roleid);
-
-      label_type get_role_label(srlnid_type roleid);
-      span_type get_role_span(srlnid_type roleid);
-      std::string get_sent_type(){return sent_p->get_type();};
-      size_t get_sent_length();
+      srlnid_type get_root() const;
+      // node ids are dense, from 0 to get_node_count() - 1
+      size_t get_node_count() const;
+      std::vector<srlnid_type> get_preds() const;
+      std::vector<srlnid_type> get_args(srlnid_type predid) const;
+
+      srlnid_type get_pred(srlnid_type argid) const;
+
+      std::vector<std::string> get_sentence() const;
+      std::vector<std::string> get_role_filler_units(srlnid_type roleid) const;
+      std::vector<tokid_type> get_role_filler_unitids(srlnid_type roleid) const;
+      matview_t get_role_filler_embs(srlnid_type roleid) const;
+      // the units of the filler within those of the sentence: the filler
+      // units are get_unitids()[first] to get_unitids()[second - 1]
+      span_type get_role_uspan(srlnid_type roleid) const;
+      std::vector<tokid_type> get_unitids() const;
+      matview_t get_embs() const;
+      size_t get_unit_size() const;
+
+      const label_type& get_role_label(srlnid_type roleid) const;
+      labelid_type get_role_labelid(srlnid_type roleid) const;
+      span_type get_role_span(srlnid_type roleid) const;
+      std::string get_sent_type() const {return sent_p->get_type();};
+      size_t get_sent_length() const;
 
       void set_tokens(std::vector<std::string>& tokens);
       void set_sent(sent_t* sent);
@@ -76,7 +91,7 @@ namespace yisi {
       void delete_sent();
 
    private:
-      graph_t<span_type, label_type> srl_m;
+      graph_t<span_type, labelid_type> srl_m;
       sent_t* sent_p;
       // std::vector<std::string> tokens_m;
       srlnid_type root_m;
@@ -85,6 +100,10 @@ namespace yisi {
    
    std::ostream& operator<<(std::ostream& os, srlgraph_t& srl);
 
+   // the role labels of all srl graphs, interned as they are built so that
+   // the scorer compares and looks them up as ids
+   vocab_t& get_labelvocab();
+
 } // yisi
 
 #endif
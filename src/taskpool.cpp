@@ -0,0 +1,131 @@
+/**
+ * @file taskpool.cpp
+ * @brief Task pool
+ *
+ * @author agent
+ *
+ * Class implementation for the classes:
+ *    - taskpool_t
+ * and the definition of the process-wide task pool.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "taskpool.h"
+
+#include <algorithm>
+
+using namespace yisi;
+using namespace std;
+
+taskpool_t::taskpool_t(size_t nthreads) : stop_m(false) {
+   set_threads(nthreads);
+}
+
+taskpool_t::~taskpool_t() {
+   stop();
+}
+
+void taskpool_t::set_threads(size_t nthreads) {
+   stop();
+   stop_m = false;
+   for (size_t k = 1; k < nthreads; k++) {
+      workers_m.push_back(thread(&taskpool_t::work, this));
+   }
+}
+
+void taskpool_t::stop() {
+   {
+      lock_guard<mutex> lock(mutex_m);
+      stop_m = true;
+   }
+   workcv_m.notify_all();
+   for (auto it = workers_m.begin(); it != workers_m.end(); it++) {
+      it->join();
+   }
+   workers_m.clear();
+}
+
+void taskpool_t::run(size_t n, const task_type& task) {
+   if (workers_m.empty() || n < 2) {
+      for (size_t k = 0; k < n; k++) {
+         task(k);
+      }
+      return;
+   }
+   auto batch = make_shared<batch_t>(&task, n);
+   {
+      lock_guard<mutex> lock(mutex_m);
+      queue_m.push_back(batch);
+   }
+   for (size_t k = 1; k < n && k <= workers_m.size(); k++) {
+      workcv_m.notify_one();
+   }
+   // callers waiting on their own batches may help with this one
+   donecv_m.notify_all();
+   size_t ran = drain(*batch);
+   unique_lock<mutex> lock(mutex_m);
+   finish(batch, ran);
+   // The other tasks were taken by threads still running them. Those may be
+   // waiting on nested batches of their own with every worker busy, so the
+   // queued batches are run here until this one is done rather than waited
+   // on.
+   while (batch->done_m < batch->n_m) {
+      if (queue_m.empty()) {
+         donecv_m.wait(lock);
+         continue;
+      }
+      auto other = queue_m.front();
+      lock.unlock();
+      size_t otherran = drain(*other);
+      lock.lock();
+      finish(other, otherran);
+   }
+}
+
+size_t taskpool_t::drain(batch_t& batch) {
+   size_t ran = 0;
+   for (size_t k = batch.next_m++; k < batch.n_m; k = batch.next_m++) {
+      (*batch.task_p)(k);
+      ran++;
+   }
+   return ran;
+}
+
+void taskpool_t::finish(const shared_ptr<batch_t>& batch, size_t ran) {
+   // nothing is left to take once drained
+   auto it = find(queue_m.begin(), queue_m.end(), batch);
+   if (it != queue_m.end()) {
+      queue_m.erase(it);
+   }
+   batch->done_m += ran;
+   if (ran > 0 && batch->done_m == batch->n_m) {
+      donecv_m.notify_all();
+   }
+}
+
+void taskpool_t::work() {
+   unique_lock<mutex> lock(mutex_m);
+   while (true) {
+      workcv_m.wait(lock, [this]() { return stop_m || !queue_m.empty(); });
+      if (stop_m) {
+         return;
+      }
+      auto batch = queue_m.front();
+      lock.unlock();
+      size_t ran = drain(*batch);
+      lock.lock();
+      finish(batch, ran);
+   }
+}
+
+taskpool_t& yisi::get_taskpool() {
+   // never destroyed: a task may exit the process from a worker, which
+   // could not join itself
+   static taskpool_t* pool = new taskpool_t();
+   return *pool;
+}
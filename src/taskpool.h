@@ -0,0 +1,93 @@
+/**
+ * @file taskpool.h
+ * @brief Task pool
+ *
+ * @author agent
+ *
+ * Class definition of:
+ *    - taskpool_t (fixed set of worker threads running batches of tasks)
+ * and the declaration of the process-wide task pool.
+ *
+ * A batch is the tasks 0 to n - 1 of one function. The thread that runs it
+ * and the idle workers take its tasks in turn until there are none left, so
+ * the run returns as soon as the slowest task is done. A task may run a
+ * batch of its own: its thread works on that batch, then on any other batch
+ * queued, until its own is done, so nested batches cannot deadlock. Tasks of a batch must write to their own
+ * slots; the pool makes no promise on the order they run in.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace yisi {
+
+   class taskpool_t {
+   public:
+      typedef std::function<void(size_t)> task_type;
+
+      // nthreads counts the threads running a batch, so 1 runs every task
+      // on the calling thread
+      taskpool_t(size_t nthreads = 1);
+      ~taskpool_t();
+
+      // only while no batch is running
+      void set_threads(size_t nthreads);
+      size_t get_threads() const { return workers_m.size() + 1; }
+
+      // runs task(0) to task(n - 1) and returns when they are all done
+      void run(size_t n, const task_type& task);
+
+   private:
+      taskpool_t(const taskpool_t&);
+      taskpool_t& operator=(const taskpool_t&);
+
+      struct batch_t {
+         batch_t(const task_type* task, size_t n) : task_p(task), n_m(n), next_m(0), done_m(0) {}
+         const task_type* task_p;
+         size_t n_m;
+         // next task to take
+         std::atomic<size_t> next_m;
+         // tasks done, under the pool mutex
+         size_t done_m;
+      }; // struct batch_t
+
+      // runs the tasks of batch left to take, and returns how many
+      static size_t drain(batch_t& batch);
+      // marks ran more tasks of batch as done; under the pool mutex
+      void finish(const std::shared_ptr<batch_t>& batch, size_t ran);
+      void work();
+      void stop();
+
+      std::mutex mutex_m;
+      // signals a new batch, or stopping
+      std::condition_variable workcv_m;
+      // signals a batch done, or a new batch to the callers waiting in run
+      std::condition_variable donecv_m;
+      std::deque<std::shared_ptr<batch_t> > queue_m;
+      std::vector<std::thread> workers_m;
+      bool stop_m;
+   }; // class taskpool_t
+
+   // the pool shared by the whole process; it runs every task on the calling
+   // thread, without starting any worker, until set_threads is called
+   taskpool_t& get_taskpool();
+
+} // yisi
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file taskpool_test.cpp
+ * @brief Unit test for taskpool.
+ *
+ * @author agent
+ *
+ * Runs batches of tasks writing to their own slots on pools of several
+ * sizes, with batches nested one and two levels deep in the tasks of other
+ * batches, and checks that every task ran exactly once.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "taskpool.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace yisi;
+
+int main(int argc, char* argv[])
+{
+   bool ok = true;
+   size_t sizes[] = {1, 2, 4, 8};
+   for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      taskpool_t pool(sizes[s]);
+
+      vector<size_t> flat(1000, 0);
+      pool.run(flat.size(), [&flat](size_t k) { flat[k] += k * k; });
+      bool flatok = true;
+      for (size_t k = 0; k < flat.size(); k++) {
+         flatok = flatok && flat[k] == k * k;
+      }
+
+      vector<vector<size_t> > nested(50, vector<size_t>(20, 0));
+      for (int round = 0; round < 10; round++) {
+         pool.run(nested.size(), [&pool, &nested](size_t i) {
+            pool.run(nested[i].size(), [&nested, i](size_t j) { nested[i][j] += i + j; });
+         });
+      }
+      bool nestedok = true;
+      for (size_t i = 0; i < nested.size(); i++) {
+         for (size_t j = 0; j < nested[i].size(); j++) {
+            nestedok = nestedok && nested[i][j] == 10 * (i + j);
+         }
+      }
+
+      // three levels, so that threads waiting on inner batches have the
+      // batches of the other tasks to help with
+      vector<size_t> deep(8 * 8 * 8, 0);
+      pool.run(8, [&pool, &deep](size_t i) {
+         pool.run(8, [&pool, &deep, i](size_t j) {
+            pool.run(8, [&deep, i, j](size_t k) { deep[(i * 8 + j) * 8 + k] += i + j + k; });
+         });
+      });
+      bool deepok = true;
+      for (size_t k = 0; k < deep.size(); k++) {
+         deepok = deepok && deep[k] == k / 64 + k / 8 % 8 + k % 8;
+      }
+
+      size_t empty = 0;
+      pool.run(0, [&empty](size_t k) { empty++; });
+
+      cout << pool.get_threads() << " threads: flat " << (flatok ? "OK" : "FAILED")
+           << ", nested " << (nestedok ? "OK" : "FAILED")
+           << ", deep " << (deepok ? "OK" : "FAILED")
+           << ", empty " << (empty == 0 ? "OK" : "FAILED") << endl;
+      ok = ok && flatok && nestedok && deepok && empty == 0;
+   }
+
+   taskpool_t pool(4);
+   pool.set_threads(2);
+   vector<int> after(100, 0);
+   pool.run(after.size(), [&after](size_t k) { after[k] = 1; });
+   size_t ran = 0;
+   for (size_t k = 0; k < after.size(); k++) {
+      ran += after[k];
+   }
+   cout << "resized to " << pool.get_threads() << " threads: " << (ran == after.size() ? "OK" : "FAILED")
+        << endl;
+   ok = ok && ran == after.size();
+
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,487 @@
+/**
+ * @file vecsim.cpp
+ * @brief Vectorized similarity kernels over float32 word vectors
+ *
+ * @author agent
+ *
+ * Scalar, SSE2, AVX2 and AVX-512 versions of the kernels declared in
+ * vecsim.h. Component i always goes to partial sum i % VECSIM_LANES and
+ * the partial sums are reduced pairwise, so every version returns the
+ * same bits as the scalar one.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "vecsim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECSIM_X86
+#include <immintrin.h>
+#endif
+
+using namespace yisi;
+using namespace std;
+
+namespace {
+   const int VECSIM_LANES = 16;
+
+   // ref and hyp rows kept together in cache by dot_block
+   const int VECSIM_BLOCK = 32;
+
+   typedef double (*dot_func_type)(const float*, const float*, int);
+   // dot products of one row a with a tile of consecutive rows b
+   typedef void (*dottile_func_type)(const float*, const float* const*, int, double*);
+   typedef void (*minmax_func_type)(const float*, double, const float*, double,
+                                    int, int, double&, double&);
+
+   struct kernels_t {
+      string isa_m;
+      dot_func_type dot_m;
+      dottile_func_type dottile_m;
+      int tile_m;
+      minmax_func_type minmax_m;
+   };
+
+   double reduce(double* acc) {
+      for (int w = VECSIM_LANES / 2; w > 0; w /= 2) {
+         for (int k = 0; k < w; k++) {
+            acc[k] += acc[k + w];
+         }
+      }
+      return acc[0];
+   }
+
+   void dot_tail(const float* a, const float* b, int i, int n, double* acc) {
+      for (; i < n; i++) {
+         acc[i % VECSIM_LANES] += (double)a[i] * (double)b[i];
+      }
+   }
+
+   void minmax_tail(const float* a, double alen, const float* b, double blen,
+                    int i, int n, int mode, double* mins, double* maxs) {
+      for (; i < n; i++) {
+         double x = a[i] / alen;
+         double y = b[i] / blen;
+         int k = i % VECSIM_LANES;
+         if (mode == 0 || (x >= 0 && y >= 0)) {
+            if (x >= y) {
+               mins[k] += y;
+               maxs[k] += x;
+            } else {
+               mins[k] += x;
+               maxs[k] += y;
+            }
+         } else {
+            mins[k] += 0.0;
+            maxs[k] += fabs(x) + fabs(y);
+         }
+      }
+   }
+
+   double dot_scalar(const float* a, const float* b, int n) {
+      double acc[VECSIM_LANES] = {0.0};
+      dot_tail(a, b, 0, n, acc);
+      return reduce(acc);
+   }
+
+   void dottile_scalar(const float* a, const float* const* b, int n, double* out) {
+      out[0] = dot_scalar(a, b[0], n);
+   }
+
+   void minmax_scalar(const float* a, double alen, const float* b, double blen,
+                      int n, int mode, double& min, double& max) {
+      double mins[VECSIM_LANES] = {0.0};
+      double maxs[VECSIM_LANES] = {0.0};
+      minmax_tail(a, alen, b, blen, 0, n, mode, mins, maxs);
+      min = reduce(mins);
+      max = reduce(maxs);
+   }
+
+#ifdef VECSIM_X86
+   __attribute__((target("sse2")))
+   double dot_sse2(const float* a, const float* b, int n) {
+      __m128d acc[8];
+      for (int k = 0; k < 8; k++) {
+         acc[k] = _mm_setzero_pd();
+      }
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         for (int k = 0; k < 4; k++) {
+            __m128 fa = _mm_loadu_ps(a + i + 4 * k);
+            __m128 fb = _mm_loadu_ps(b + i + 4 * k);
+            acc[2 * k] = _mm_add_pd(acc[2 * k], _mm_mul_pd(_mm_cvtps_pd(fa), _mm_cvtps_pd(fb)));
+            acc[2 * k + 1] = _mm_add_pd(acc[2 * k + 1],
+               _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(fa, fa)), _mm_cvtps_pd(_mm_movehl_ps(fb, fb))));
+         }
+      }
+      double sums[VECSIM_LANES];
+      for (int k = 0; k < 8; k++) {
+         _mm_storeu_pd(sums + 2 * k, acc[k]);
+      }
+      dot_tail(a, b, i, n, sums);
+      return reduce(sums);
+   }
+
+   __attribute__((target("sse2")))
+   void dottile_sse2(const float* a, const float* const* b, int n, double* out) {
+      out[0] = dot_sse2(a, b[0], n);
+   }
+
+   __attribute__((target("sse2")))
+   inline void minmax_sse2_step(__m128d x, __m128d y, int mode, __m128d& mins, __m128d& maxs) {
+      __m128d ge = _mm_cmpge_pd(x, y);
+      __m128d mn = _mm_or_pd(_mm_and_pd(ge, y), _mm_andnot_pd(ge, x));
+      __m128d mx = _mm_or_pd(_mm_and_pd(ge, x), _mm_andnot_pd(ge, y));
+      if (mode == 0) {
+         mins = _mm_add_pd(mins, mn);
+         maxs = _mm_add_pd(maxs, mx);
+      } else {
+         __m128d zero = _mm_setzero_pd();
+         __m128d pos = _mm_and_pd(_mm_cmpge_pd(x, zero), _mm_cmpge_pd(y, zero));
+         __m128d sign = _mm_set1_pd(-0.0);
+         __m128d mag = _mm_add_pd(_mm_andnot_pd(sign, x), _mm_andnot_pd(sign, y));
+         mins = _mm_add_pd(mins, _mm_and_pd(pos, mn));
+         maxs = _mm_add_pd(maxs, _mm_or_pd(_mm_and_pd(pos, mx), _mm_andnot_pd(pos, mag)));
+      }
+   }
+
+   __attribute__((target("sse2")))
+   void minmax_sse2(const float* a, double alen, const float* b, double blen,
+                    int n, int mode, double& min, double& max) {
+      __m128d mins[8];
+      __m128d maxs[8];
+      for (int k = 0; k < 8; k++) {
+         mins[k] = _mm_setzero_pd();
+         maxs[k] = _mm_setzero_pd();
+      }
+      __m128d la = _mm_set1_pd(alen);
+      __m128d lb = _mm_set1_pd(blen);
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         for (int k = 0; k < 4; k++) {
+            __m128 fa = _mm_loadu_ps(a + i + 4 * k);
+            __m128 fb = _mm_loadu_ps(b + i + 4 * k);
+            minmax_sse2_step(_mm_div_pd(_mm_cvtps_pd(fa), la), _mm_div_pd(_mm_cvtps_pd(fb), lb),
+                             mode, mins[2 * k], maxs[2 * k]);
+            minmax_sse2_step(_mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(fa, fa)), la),
+                             _mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(fb, fb)), lb),
+                             mode, mins[2 * k + 1], maxs[2 * k + 1]);
+         }
+      }
+      double smins[VECSIM_LANES];
+      double smaxs[VECSIM_LANES];
+      for (int k = 0; k < 8; k++) {
+         _mm_storeu_pd(smins + 2 * k, mins[k]);
+         _mm_storeu_pd(smaxs + 2 * k, maxs[k]);
+      }
+      minmax_tail(a, alen, b, blen, i, n, mode, smins, smaxs);
+      min = reduce(smins);
+      max = reduce(smaxs);
+   }
+
+   __attribute__((target("avx2")))
+   double dot_avx2(const float* a, const float* b, int n) {
+      __m256d acc[4];
+      for (int k = 0; k < 4; k++) {
+         acc[k] = _mm256_setzero_pd();
+      }
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         for (int k = 0; k < 4; k++) {
+            __m256d da = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 4 * k));
+            __m256d db = _mm256_cvtps_pd(_mm_loadu_ps(b + i + 4 * k));
+            acc[k] = _mm256_add_pd(acc[k], _mm256_mul_pd(da, db));
+         }
+      }
+      double sums[VECSIM_LANES];
+      for (int k = 0; k < 4; k++) {
+         _mm256_storeu_pd(sums + 4 * k, acc[k]);
+      }
+      dot_tail(a, b, i, n, sums);
+      return reduce(sums);
+   }
+
+   // two dot products per pass over a, each with the partial sums of dot_avx2
+   __attribute__((target("avx2")))
+   void dottile_avx2(const float* a, const float* const* b, int n, double* out) {
+      const float* b0 = b[0];
+      const float* b1 = b[1];
+      __m256d acc0[4];
+      __m256d acc1[4];
+      for (int k = 0; k < 4; k++) {
+         acc0[k] = _mm256_setzero_pd();
+         acc1[k] = _mm256_setzero_pd();
+      }
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         for (int k = 0; k < 4; k++) {
+            __m256d da = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 4 * k));
+            acc0[k] = _mm256_add_pd(acc0[k], _mm256_mul_pd(da, _mm256_cvtps_pd(_mm_loadu_ps(b0 + i + 4 * k))));
+            acc1[k] = _mm256_add_pd(acc1[k], _mm256_mul_pd(da, _mm256_cvtps_pd(_mm_loadu_ps(b1 + i + 4 * k))));
+         }
+      }
+      double sums0[VECSIM_LANES];
+      double sums1[VECSIM_LANES];
+      for (int k = 0; k < 4; k++) {
+         _mm256_storeu_pd(sums0 + 4 * k, acc0[k]);
+         _mm256_storeu_pd(sums1 + 4 * k, acc1[k]);
+      }
+      dot_tail(a, b0, i, n, sums0);
+      dot_tail(a, b1, i, n, sums1);
+      out[0] = reduce(sums0);
+      out[1] = reduce(sums1);
+   }
+
+   __attribute__((target("avx2")))
+   void minmax_avx2(const float* a, double alen, const float* b, double blen,
+                    int n, int mode, double& min, double& max) {
+      __m256d mins[4];
+      __m256d maxs[4];
+      for (int k = 0; k < 4; k++) {
+         mins[k] = _mm256_setzero_pd();
+         maxs[k] = _mm256_setzero_pd();
+      }
+      __m256d la = _mm256_set1_pd(alen);
+      __m256d lb = _mm256_set1_pd(blen);
+      __m256d zero = _mm256_setzero_pd();
+      __m256d sign = _mm256_set1_pd(-0.0);
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         for (int k = 0; k < 4; k++) {
+            __m256d x = _mm256_div_pd(_mm256_cvtps_pd(_mm_loadu_ps(a + i + 4 * k)), la);
+            __m256d y = _mm256_div_pd(_mm256_cvtps_pd(_mm_loadu_ps(b + i + 4 * k)), lb);
+            __m256d ge = _mm256_cmp_pd(x, y, _CMP_GE_OQ);
+            __m256d mn = _mm256_blendv_pd(x, y, ge);
+            __m256d mx = _mm256_blendv_pd(y, x, ge);
+            if (mode == 0) {
+               mins[k] = _mm256_add_pd(mins[k], mn);
+               maxs[k] = _mm256_add_pd(maxs[k], mx);
+            } else {
+               __m256d pos = _mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_GE_OQ),
+                                           _mm256_cmp_pd(y, zero, _CMP_GE_OQ));
+               __m256d mag = _mm256_add_pd(_mm256_andnot_pd(sign, x), _mm256_andnot_pd(sign, y));
+               mins[k] = _mm256_add_pd(mins[k], _mm256_and_pd(pos, mn));
+               maxs[k] = _mm256_add_pd(maxs[k], _mm256_blendv_pd(mag, mx, pos));
+            }
+         }
+      }
+      double smins[VECSIM_LANES];
+      double smaxs[VECSIM_LANES];
+      for (int k = 0; k < 4; k++) {
+         _mm256_storeu_pd(smins + 4 * k, mins[k]);
+         _mm256_storeu_pd(smaxs + 4 * k, maxs[k]);
+      }
+      minmax_tail(a, alen, b, blen, i, n, mode, smins, smaxs);
+      min = reduce(smins);
+      max = reduce(smaxs);
+   }
+
+   // _mm512_cvtps_pd starts from _mm512_undefined_pd(), which gcc flags
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+   __attribute__((target("avx512f")))
+   double dot_avx512(const float* a, const float* b, int n) {
+      __m512d acc0 = _mm512_setzero_pd();
+      __m512d acc1 = _mm512_setzero_pd();
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i)),
+                                                  _mm512_cvtps_pd(_mm256_loadu_ps(b + i))));
+         acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8)),
+                                                  _mm512_cvtps_pd(_mm256_loadu_ps(b + i + 8))));
+      }
+      double sums[VECSIM_LANES];
+      _mm512_storeu_pd(sums, acc0);
+      _mm512_storeu_pd(sums + 8, acc1);
+      dot_tail(a, b, i, n, sums);
+      return reduce(sums);
+   }
+
+   // four dot products per pass over a, each with the partial sums of dot_avx512
+   __attribute__((target("avx512f")))
+   void dottile_avx512(const float* a, const float* const* b, int n, double* out) {
+      __m512d acc[4][2];
+      for (int t = 0; t < 4; t++) {
+         acc[t][0] = _mm512_setzero_pd();
+         acc[t][1] = _mm512_setzero_pd();
+      }
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         __m512d da0 = _mm512_cvtps_pd(_mm256_loadu_ps(a + i));
+         __m512d da1 = _mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8));
+         for (int t = 0; t < 4; t++) {
+            acc[t][0] = _mm512_add_pd(acc[t][0], _mm512_mul_pd(da0, _mm512_cvtps_pd(_mm256_loadu_ps(b[t] + i))));
+            acc[t][1] = _mm512_add_pd(acc[t][1], _mm512_mul_pd(da1, _mm512_cvtps_pd(_mm256_loadu_ps(b[t] + i + 8))));
+         }
+      }
+      for (int t = 0; t < 4; t++) {
+         double sums[VECSIM_LANES];
+         _mm512_storeu_pd(sums, acc[t][0]);
+         _mm512_storeu_pd(sums + 8, acc[t][1]);
+         dot_tail(a, b[t], i, n, sums);
+         out[t] = reduce(sums);
+      }
+   }
+
+   __attribute__((target("avx512f")))
+   void minmax_avx512(const float* a, double alen, const float* b, double blen,
+                      int n, int mode, double& min, double& max) {
+      __m512d mins[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+      __m512d maxs[2] = {_mm512_setzero_pd(), _mm512_setzero_pd()};
+      __m512d la = _mm512_set1_pd(alen);
+      __m512d lb = _mm512_set1_pd(blen);
+      __m512d zero = _mm512_setzero_pd();
+      int i = 0;
+      for (; i + VECSIM_LANES <= n; i += VECSIM_LANES) {
+         for (int k = 0; k < 2; k++) {
+            __m512d x = _mm512_div_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8 * k)), la);
+            __m512d y = _mm512_div_pd(_mm512_cvtps_pd(_mm256_loadu_ps(b + i + 8 * k)), lb);
+            __mmask8 ge = _mm512_cmp_pd_mask(x, y, _CMP_GE_OQ);
+            __m512d mn = _mm512_mask_blend_pd(ge, x, y);
+            __m512d mx = _mm512_mask_blend_pd(ge, y, x);
+            if (mode == 0) {
+               mins[k] = _mm512_add_pd(mins[k], mn);
+               maxs[k] = _mm512_add_pd(maxs[k], mx);
+            } else {
+               __mmask8 pos = _mm512_cmp_pd_mask(x, zero, _CMP_GE_OQ)
+                            & _mm512_cmp_pd_mask(y, zero, _CMP_GE_OQ);
+               __m512d mag = _mm512_add_pd(_mm512_abs_pd(x), _mm512_abs_pd(y));
+               mins[k] = _mm512_add_pd(mins[k], _mm512_maskz_mov_pd(pos, mn));
+               maxs[k] = _mm512_add_pd(maxs[k], _mm512_mask_blend_pd(pos, mag, mx));
+            }
+         }
+      }
+      double smins[VECSIM_LANES];
+      double smaxs[VECSIM_LANES];
+      _mm512_storeu_pd(smins, mins[0]);
+      _mm512_storeu_pd(smins + 8, mins[1]);
+      _mm512_storeu_pd(smaxs, maxs[0]);
+      _mm512_storeu_pd(smaxs + 8, maxs[1]);
+      minmax_tail(a, alen, b, blen, i, n, mode, smins, smaxs);
+      min = reduce(smins);
+      max = reduce(smaxs);
+   }
+#pragma GCC diagnostic pop
+#endif
+
+   bool supports(const string& isa) {
+      if (isa == "scalar") {
+         return true;
+      }
+#ifdef VECSIM_X86
+      __builtin_cpu_init();
+      if (isa == "sse2") {
+         return __builtin_cpu_supports("sse2");
+      } else if (isa == "avx2") {
+         return __builtin_cpu_supports("avx2");
+      } else if (isa == "avx512") {
+         return __builtin_cpu_supports("avx512f");
+      }
+#endif
+      return false;
+   }
+
+   kernels_t make_kernels(const string& isa) {
+      kernels_t k;
+      k.isa_m = "scalar";
+      k.dot_m = dot_scalar;
+      k.dottile_m = dottile_scalar;
+      k.tile_m = 1;
+      k.minmax_m = minmax_scalar;
+#ifdef VECSIM_X86
+      if (isa == "sse2") {
+         k.isa_m = isa;
+         k.dot_m = dot_sse2;
+         k.dottile_m = dottile_sse2;
+         k.minmax_m = minmax_sse2;
+      } else if (isa == "avx2") {
+         k.isa_m = isa;
+         k.dot_m = dot_avx2;
+         k.dottile_m = dottile_avx2;
+         k.tile_m = 2;
+         k.minmax_m = minmax_avx2;
+      } else if (isa == "avx512") {
+         k.isa_m = isa;
+         k.dot_m = dot_avx512;
+         k.dottile_m = dottile_avx512;
+         k.tile_m = 4;
+         k.minmax_m = minmax_avx512;
+      }
+#endif
+      return k;
+   }
+
+   kernels_t& get_kernels() {
+      static kernels_t kernels = make_kernels(supports("avx512") ? "avx512"
+                                              : supports("avx2") ? "avx2"
+                                              : supports("sse2") ? "sse2" : "scalar");
+      return kernels;
+   }
+} // anonymous namespace
+
+simfunc_type yisi::get_simfunc(string funcname) {
+   if (funcname == "ucosine") {
+      return UCOSINE_FUNC;
+   } else if (funcname == "cosine") {
+      return COSINE_FUNC;
+   } else if (funcname == "tcosine") {
+      return TCOSINE_FUNC;
+   } else if (funcname == "jaccard") {
+      return JACCARD_FUNC;
+   } else if (funcname == "mjaccard") {
+      return MJACCARD_FUNC;
+   } else {
+      cerr << "ERROR: Unknown lexsim function " << funcname << endl;
+      exit(1);
+   }
+}
+
+double yisi::dot_f32(const float* a, const float* b, int n) {
+   return get_kernels().dot_m(a, b, n);
+}
+
+void yisi::dot_f32_block(const float* const* a, int m, const float* const* b, int n,
+                         int dim, double* out) {
+   const kernels_t& k = get_kernels();
+   for (int ib = 0; ib < m; ib += VECSIM_BLOCK) {
+      int ie = min(m, ib + VECSIM_BLOCK);
+      for (int jb = 0; jb < n; jb += VECSIM_BLOCK) {
+         int je = min(n, jb + VECSIM_BLOCK);
+         for (int i = ib; i < ie; i++) {
+            int j = jb;
+            for (; j + k.tile_m <= je; j += k.tile_m) {
+               k.dottile_m(a[i], b + j, dim, out + (size_t)i * n + j);
+            }
+            for (; j < je; j++) {
+               out[(size_t)i * n + j] = k.dot_m(a[i], b[j], dim);
+            }
+         }
+      }
+   }
+}
+
+void yisi::minmax_f32(const float* a, double alen, const float* b, double blen,
+                      int n, int mode, double& min, double& max) {
+   get_kernels().minmax_m(a, alen, b, blen, n, mode, min, max);
+}
+
+string yisi::get_simd_isa() {
+   return get_kernels().isa_m;
+}
+
+bool yisi::set_simd_isa(string isa) {
+   if (!supports(isa)) {
+      return false;
+   }
+   get_kernels() = make_kernels(isa);
+   return true;
+}
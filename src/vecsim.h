@@ -0,0 +1,58 @@
+/**
+ * @file vecsim.h
+ * @brief Vectorized similarity kernels over float32 word vectors
+ *
+ * @author agent
+ *
+ * Declaration of the kernels behind yisi::cosine and yisi::jaccard for
+ * embedding table rows. The instruction set (scalar, SSE2, AVX2 or AVX-512)
+ * is chosen once at runtime from what the CPU supports.
+ *
+ * All variants accumulate in double over the same 16 interleaved partial
+ * sums and reduce them in the same order, so a score does not depend on
+ * the CPU it is computed on. Compared to summing the normalized components
+ * one by one, as the former std::vector<double> kernels did, results differ
+ * only by rounding (well below 1e-12 for unit vectors).
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef VECSIM_H
+#define VECSIM_H
+
+#include <string>
+
+namespace yisi {
+
+   enum simfunc_type {
+      UCOSINE_FUNC,
+      COSINE_FUNC,
+      TCOSINE_FUNC,
+      JACCARD_FUNC,
+      MJACCARD_FUNC
+   };
+
+   simfunc_type get_simfunc(std::string funcname);
+
+   // sum of a[i] * b[i] over n components
+   double dot_f32(const float* a, const float* b, int n);
+   // out[i * n + j] = dot_f32(a[i], b[j], dim), computed block by block
+   void dot_f32_block(const float* const* a, int m, const float* const* b, int n,
+                      int dim, double* out);
+   // sums of the component-wise min and max of a[i] / alen and b[i] / blen;
+   // in mode 1, components of different signs add their magnitudes to max only
+   void minmax_f32(const float* a, double alen, const float* b, double blen,
+                   int n, int mode, double& min, double& max);
+
+   // name of the instruction set in use
+   std::string get_simd_isa();
+   // force an instruction set [scalar|sse2|avx2|avx512]; false if unsupported
+   bool set_simd_isa(std::string isa);
+
+} // yisi
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file vecsim_test.cpp
+ * @brief Unit test for vecsim.
+ *
+ * @author agent
+ *
+ * Checks that every instruction set supported by the CPU returns the same
+ * bits as the scalar kernels, including the blocked dot products, and that
+ * the kernels agree with the plain normalized double sums within the
+ * documented tolerance.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "vecsim.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace yisi;
+
+int main(int argc, char* argv[])
+{
+   const char* isas[] = {"scalar", "sse2", "avx2", "avx512"};
+   int sizes[] = {1, 7, 15, 16, 17, 33, 300};
+   srand(1);
+   bool ok = true;
+
+   for (size_t s = 0; s < sizeof(sizes) / sizeof(int); s++) {
+      int n = sizes[s];
+      vector<float> a(n);
+      vector<float> b(n);
+      double alen = 0.0;
+      double blen = 0.0;
+      for (int i = 0; i < n; i++) {
+         a[i] = (float)rand() / RAND_MAX - 0.5f;
+         b[i] = (float)rand() / RAND_MAX - 0.5f;
+         alen += a[i] * a[i];
+         blen += b[i] * b[i];
+      }
+      alen = sqrt(alen);
+      blen = sqrt(blen);
+
+      // plain sums over the normalized components
+      double cos = 0.0;
+      double min[2] = {0.0, 0.0};
+      double max[2] = {0.0, 0.0};
+      for (int i = 0; i < n; i++) {
+         double x = a[i] / alen;
+         double y = b[i] / blen;
+         cos += x * y;
+         for (int mode = 0; mode < 2; mode++) {
+            if (mode == 0 || (x >= 0 && y >= 0)) {
+               min[mode] += std::min(x, y);
+               max[mode] += std::max(x, y);
+            } else {
+               max[mode] += fabs(x) + fabs(y);
+            }
+         }
+      }
+
+      set_simd_isa("scalar");
+      double rdot = dot_f32(a.data(), b.data(), n);
+      double rmin[2];
+      double rmax[2];
+      for (int mode = 0; mode < 2; mode++) {
+         minmax_f32(a.data(), alen, b.data(), blen, n, mode, rmin[mode], rmax[mode]);
+      }
+      if (fabs(rdot / (alen * blen) - cos) > 1e-12) {
+         cout << "cosine n=" << n << ": FAILED" << endl;
+         ok = false;
+      }
+      for (int mode = 0; mode < 2; mode++) {
+         if (fabs(rmin[mode] / rmax[mode] - min[mode] / max[mode]) > 1e-12) {
+            cout << "jaccard mode " << mode << " n=" << n << ": FAILED" << endl;
+            ok = false;
+         }
+      }
+
+      for (size_t k = 1; k < sizeof(isas) / sizeof(char*); k++) {
+         if (!set_simd_isa(isas[k])) {
+            continue;
+         }
+         if (dot_f32(a.data(), b.data(), n) != rdot) {
+            cout << isas[k] << " dot n=" << n << ": FAILED" << endl;
+            ok = false;
+         }
+         for (int mode = 0; mode < 2; mode++) {
+            double vmin;
+            double vmax;
+            minmax_f32(a.data(), alen, b.data(), blen, n, mode, vmin, vmax);
+            if (vmin != rmin[mode] || vmax != rmax[mode]) {
+               cout << isas[k] << " minmax mode " << mode << " n=" << n << ": FAILED" << endl;
+               ok = false;
+            }
+         }
+      }
+
+      // a block of rows spanning several tiles, with ragged edges
+      const int m = 37;
+      const int k = 45;
+      vector<vector<float> > rows(m + k, vector<float>(n));
+      vector<const float*> ap;
+      vector<const float*> bp;
+      for (int r = 0; r < m + k; r++) {
+         for (int i = 0; i < n; i++) {
+            rows[r][i] = (float)rand() / RAND_MAX - 0.5f;
+         }
+         (r < m ? ap : bp).push_back(rows[r].data());
+      }
+      set_simd_isa("scalar");
+      vector<double> rblock(m * k);
+      for (int i = 0; i < m; i++) {
+         for (int j = 0; j < k; j++) {
+            rblock[i * k + j] = dot_f32(ap[i], bp[j], n);
+         }
+      }
+      for (size_t t = 0; t < sizeof(isas) / sizeof(char*); t++) {
+         if (!set_simd_isa(isas[t])) {
+            continue;
+         }
+         vector<double> block(m * k);
+         dot_f32_block(ap.data(), m, bp.data(), k, n, block.data());
+         if (block != rblock) {
+            cout << isas[t] << " dot block n=" << n << ": FAILED" << endl;
+            ok = false;
+         }
+      }
+      cout << "n=" << n << ": " << (ok ? "OK" : "FAILED") << endl;
+   }
+
+   return ok ? 0 : 1;
+}
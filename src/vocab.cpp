@@ -0,0 +1,70 @@
+/**
+ * @file vocab.cpp
+ * @brief Token vocabulary
+ *
+ * @author agent
+ *
+ * Class implementation for the classes:
+ *    - vocab_t
+ * and the definitions of some utility functions working on it.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#include "vocab.h"
+#include "util.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace yisi;
+using namespace std;
+
+tokid_type vocab_t::intern(const string& token) {
+   auto it = id_m.find(token);
+   if (it != id_m.end()) {
+      return it->second;
+   }
+   if (frozen_m) {
+      cerr << "ERROR: token \"" << token << "\" interned after the scoring started. Exiting..." << endl;
+      exit(1);
+   }
+   tokid_type id = (tokid_type)token_m.size();
+   id_m[token] = id;
+   token_m.push_back(token);
+   lcid_m.push_back(id);
+   string lc = lowercase(token);
+   if (lc != token) {
+      // interning lc may grow lcid_m
+      tokid_type lcid = intern(lc);
+      lcid_m[id] = lcid;
+   }
+   return id;
+}
+
+tokid_type vocab_t::lookup(const string& token) const {
+   auto it = id_m.find(token);
+   if (it == id_m.end()) {
+      return UNKNOWN_TOKID;
+   }
+   return it->second;
+}
+
+vocab_t& yisi::get_vocab() {
+   static vocab_t vocab;
+   return vocab;
+}
+
+vector<tokid_type> yisi::intern(const vector<string>& tokens) {
+   vector<tokid_type> result;
+   result.reserve(tokens.size());
+   vocab_t& vocab = get_vocab();
+   for (auto it = tokens.begin(); it != tokens.end(); it++) {
+      result.push_back(vocab.intern(*it));
+   }
+   return result;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file vocab.h
+ * @brief Token vocabulary
+ *
+ * @author agent
+ *
+ * Class definition of:
+ *    - vocab_t (corpus-wide table interning every token into an integer id)
+ * and the declaration of some utility functions working on it.
+ *
+ * Tokens are interned once when the sentences are read; the scoring path
+ * then passes ids around. Two ids are equal iff their tokens are equal, and
+ * each id knows the id of its lowercased form. Models keep their own dense
+ * id-indexed tables (embedding row, lexical weight) next to the vocabulary.
+ *
+ * The vocabulary is not locked: the scoring threads only read it, through
+ * lookup() rather than intern(), and freeze() makes any later attempt to
+ * intern a new token an error.
+ *
+ * Multilingual Text Processing / Traitement multilingue de textes
+ * Digital Technologies Research Centre / Centre de recherche en technologies numériques
+ * National Research Council Canada / Conseil national de recherches Canada
+ * Copyright 2026, His Majesty the King in Right of Canada /
+ * Copyright 2026, Sa Majeste le Roi du chef du Canada
+ */
+
+#ifndef VOCAB_H
+#define VOCAB_H
+
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace yisi {
+
+   typedef uint32_t tokid_type;
+   // id returned by lookup() for a token never interned
+   static const tokid_type UNKNOWN_TOKID = (tokid_type)-1;
+
+   class vocab_t {
+   public:
+      vocab_t() : frozen_m(false) {}
+      tokid_type intern(const std::string& token);
+      // id of an interned token or UNKNOWN_TOKID, without interning it
+      tokid_type lookup(const std::string& token) const;
+      // no new token may be interned from now on, e.g. once the scoring
+      // threads have started reading the vocabulary
+      void freeze() { frozen_m = true; }
+      const std::string& get_token(tokid_type id) const { return token_m[id]; }
+      // id of the lowercased token
+      tokid_type get_lcid(tokid_type id) const { return lcid_m[id]; }
+      size_t size() const { return token_m.size(); }
+   private:
+      vocab_t(const vocab_t&);
+      vocab_t& operator=(const vocab_t&);
+
+      std::unordered_map<std::string, tokid_type> id_m;
+      // a deque keeps the references returned by get_token valid
+      std::deque<std::string> token_m;
+      std::vector<tokid_type> lcid_m;
+      bool frozen_m;
+   }; // class vocab_t
+
+   // the vocabulary shared by all sentences and models
+   vocab_t& get_vocab();
+   std::vector<tokid_type> intern(const std::vector<std::string>& tokens);
+
+} // yisi
+
+#endif
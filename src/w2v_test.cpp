@@ -22,7 +22,12 @@ int main(int argc, char* argv[])
 {
    lexsim_t w2vtxt("w2v", argv[1], "cosine");
    if (argc == 3) {
-      w2vtxt.write_txtw2v(argv[2]);
+      string outpath = argv[2];
+      if (outpath.size() >= 5 && outpath.substr(outpath.size() - 5) == "mmw2v") {
+         w2vtxt.write_mmw2v(outpath);
+      } else {
+         w2vtxt.write_txtw2v(outpath);
+      }
    }
 
    string s1;
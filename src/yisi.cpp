@@ -13,12 +13,16 @@
 
 #include "cmdlp/options.h"
 #include "yisiscorer.h"
+#include "taskpool.h"
 
 #include <iostream>
 #include <vector>
 #include <fstream>
 #include <string>
 #include <ctime>
+#include <mutex>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 using namespace yisi;
@@ -43,6 +47,8 @@ struct eval_options {
 
    std::string mode_m;
 
+   size_t threads_m;
+
    void init(com::masaers::cmdlp::parser& p) {
       using namespace com::masaers::cmdlp;
       p.add(make_knob(ref_type_m))
@@ -123,6 +129,11 @@ struct eval_options {
                "| features: print feature weights and scores separated by white space]")
          .name("mode")
          ;
+      p.add(make_knob(threads_m))
+         .fallback(1)
+         .desc("Number of threads scoring the sentences [default 1; 0: one per core]")
+         .name("threads")
+         ;
    }
 }; // struct eval_options
 
@@ -157,7 +168,34 @@ int main(const int argc, const char* argv[])
       }
    }
 
+   if (opt.lexsimvocab_name_m == "test") {
+      if (opt.outlexsimvocab_path_m == "") {
+         vector<string> paths;
+         paths.push_back(opt.hyp_file_m);
+         if (opt.hypunit_file_m != "") {
+            paths.push_back(opt.hypunit_file_m);
+         }
+         if (opt.ref_file_m != "") {
+            paths.push_back(opt.ref_file_m);
+         }
+         if (opt.refunit_file_m != "") {
+            paths.push_back(opt.refunit_file_m);
+         }
+         opt.outlexsimvocab_path_m = join(paths, ":");
+      }
+      if (opt.inplexsimvocab_path_m == "" && opt.inp_file_m != "") {
+         opt.inplexsimvocab_path_m = opt.inp_file_m;
+         if (opt.inpunit_file_m != "") {
+            opt.inplexsimvocab_path_m += ":" + opt.inpunit_file_m;
+         }
+      }
+   } else if (opt.lexsimvocab_name_m != "all") {
+      cerr << "ERROR: Unknown lexsimvocab type " << opt.lexsimvocab_name_m << ". Exiting..." << endl;
+      exit(1);
+   }
+
    yisiscorer_t<options_type> yisi(opt);
+   yisi.readcache();
 
    if (opt.sntscore_file_m == "") {
       opt.sntscore_file_m = opt.hyp_file_m + ".sntyisi";
@@ -180,6 +218,9 @@ int main(const int argc, const char* argv[])
       auto reffiles = tokenize(opt.ref_file_m, ':');
       auto refunits = tokenize(opt.refunit_file_m, ':');
       auto refidemb = tokenize(opt.refidemb_file_m, ':');
+      // unit and embedding files are optional for every reference
+      refunits.resize(reffiles.size());
+      refidemb.resize(reffiles.size());
       size_t i = 0;
       vector<sent_t*> rs;
       if (reffiles.size() == refunits.size()) {
@@ -254,10 +295,30 @@ int main(const int argc, const char* argv[])
       cerr << "Done." << endl;
    }
 
-   double docscore = 0.0;
+   yisi.prepare(opt.inp_file_m != "");
+   // the scoring threads only read the vocabulary from here on
+   get_vocab().freeze();
 
-   for (size_t i = 0; i < hypsrlgraphs.size(); i++) {
-      cout << "Evaluating line " << i + 1 << endl;
+   // a single thread scores the lines itself, without any worker
+   size_t threads = opt.threads_m;
+   if (threads == 0) {
+      threads = max(1u, thread::hardware_concurrency());
+   }
+   if (threads > 1) {
+      get_taskpool().set_threads(threads);
+   }
+
+   // the lines are scored in any order, and written out in order once all
+   // are done
+   vector<double> sntscores(hypsrlgraphs.size(), 0.0);
+   vector<vector<double> > sntfeatures(hypsrlgraphs.size());
+   mutex coutmutex;
+
+   get_taskpool().run(hypsrlgraphs.size(), [&](size_t i) {
+      {
+         lock_guard<mutex> lock(coutmutex);
+         cout << "Evaluating line " << i + 1 << endl;
+      }
       yisigraph_t m;
       if (opt.inp_file_m != "") {
          /*
@@ -275,11 +336,21 @@ int main(const int argc, const char* argv[])
          // m.print(cout);
       }
       if (opt.mode_m != "features") {
-         double s = yisi.score(m);
-         SNTOUT << s << endl;
-         docscore += s;
+         sntscores[i] = yisi.score(m);
+      } else {
+         sntfeatures[i] = yisi.features(m);
+      }
+   });
+
+   // summed in line order, so that the document score does not depend on
+   // the number of threads
+   double docscore = 0.0;
+   for (size_t i = 0; i < hypsrlgraphs.size(); i++) {
+      if (opt.mode_m != "features") {
+         SNTOUT << sntscores[i] << endl;
+         docscore += sntscores[i];
       } else {
-         auto f = yisi.features(m);
+         auto& f = sntfeatures[i];
          for (auto it = f.begin(); it != f.end(); it++) {
             SNTOUT << *it << " ";
          }
@@ -296,6 +367,10 @@ int main(const int argc, const char* argv[])
       DOCOUT.close();
    }
 
+   yisi.writecache();
+   print_simcache_stats(cerr);
+   print_matching_stats(cerr);
+
    for (auto it = hypsents.begin(); it != hypsents.end(); it++) {
       delete *it;
       *it = NULL;
@@ -22,64 +22,36 @@
 using namespace yisi;
 using namespace std;
 
-yisigraph_t::yisigraph_t(const vector<srlgraph_t> refsrlgraph, 
-			 const srlgraph_t hypsrlgraph) {
-   refsrlgraph_m = refsrlgraph;
-   hypsrlgraph_m = hypsrlgraph;
-   inp_b = false;
-
-   //cout << endl;
-   //cout << "refsrlgraph:" << endl;
-   //cout << refsrlgraph_m;
-   //cout << "hypsrlgraph:" << endl;
-   //cout << hypsrlgraph_m;
-   //cout<<"Done."<<endl;   
-}
-
-yisigraph_t::yisigraph_t(const vector<srlgraph_t> refsrlgraph,
-                         const srlgraph_t hypsrlgraph, const srlgraph_t inpsrlgraph) {
-   refsrlgraph_m = refsrlgraph;
-   hypsrlgraph_m = hypsrlgraph;
-   inpsrlgraph_m = inpsrlgraph;
-   inp_b = true;
-
-   //cout << endl;
-   //cout << "refsrlgraph:" << endl;
-   //cout << refsrlgraph_m;
-   //cout << "hypsrlgraph:" << endl;
-   //cout << hypsrlgraph_m;
-   //cout<<"Done."<<endl;
-}
+const yisigraph_t::srlnid_type yisigraph_t::UNALIGNED;
+const yisigraph_t::labelid_type yisigraph_t::UNLABELED;
 
-yisigraph_t::yisigraph_t(const yisigraph_t& rhs) {
-   refsrlgraph_m = rhs.refsrlgraph_m;
-   hypsrlgraph_m = rhs.hypsrlgraph_m;
-   refalignment_m = rhs.refalignment_m;
-   hypalignment_m = rhs.hypalignment_m;
-   inp_b = rhs.inp_b;
-   if (rhs.inp_b) {
-      inpsrlgraph_m = rhs.inpsrlgraph_m;
-      inpalignment_m = rhs.inpalignment_m;
+yisigraph_t::yisigraph_t(const vector<srlgraph_t>& refsrlgraph,
+                         const srlgraph_t& hypsrlgraph) {
+   refsrlgraph_m.reserve(refsrlgraph.size());
+   for (auto it = refsrlgraph.begin(); it != refsrlgraph.end(); it++) {
+      refsrlgraph_m.push_back(&*it);
    }
+   hypsrlgraph_p = &hypsrlgraph;
+   inpsrlgraph_p = NULL;
+   inp_b = false;
 }
 
-void yisigraph_t::operator=(const yisigraph_t& rhs) {
-   refsrlgraph_m = rhs.refsrlgraph_m;
-   hypsrlgraph_m = rhs.hypsrlgraph_m;
-   refalignment_m = rhs.refalignment_m;
-   hypalignment_m = rhs.hypalignment_m;
-   inp_b = rhs.inp_b;
-   if (rhs.inp_b) {
-      inpsrlgraph_m = rhs.inpsrlgraph_m;
-      inpalignment_m = rhs.inpalignment_m;
+yisigraph_t::yisigraph_t(const vector<srlgraph_t>& refsrlgraph,
+                         const srlgraph_t& hypsrlgraph, const srlgraph_t& inpsrlgraph) {
+   refsrlgraph_m.reserve(refsrlgraph.size());
+   for (auto it = refsrlgraph.begin(); it != refsrlgraph.end(); it++) {
+      refsrlgraph_m.push_back(&*it);
    }
+   hypsrlgraph_p = &hypsrlgraph;
+   inpsrlgraph_p = &inpsrlgraph;
+   inp_b = true;
 }
 
-bool yisigraph_t::withinp() {
+bool yisigraph_t::withinp() const {
    return inp_b;
 }
 
-size_t yisigraph_t::get_refsize() {
+size_t yisigraph_t::get_refsize() const {
    return refsrlgraph_m.size();
 }
 
@@ -88,17 +60,17 @@ double yisigraph_t::get_sentlength(int mode, int refid) {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return spanlength(inpsrlgraph_m.get_role_span(inpsrlgraph_m.get_root()));
+            return spanlength(inpsrlgraph_p->get_role_span(inpsrlgraph_p->get_root()));
          } else {
             return 0.0;
          }
          break;
       case yisi::HYP_MODE:
-         return spanlength(hypsrlgraph_m.get_role_span(hypsrlgraph_m.get_root()));
+         return spanlength(hypsrlgraph_p->get_role_span(hypsrlgraph_p->get_root()));
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return spanlength(refsrlgraph_m[refid].get_role_span(refsrlgraph_m[refid].get_root()));
+            return spanlength(refsrlgraph_m[refid]->get_role_span(refsrlgraph_m[refid]->get_root()));
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0,"
                  << refsrlgraph_m.size() << "]. Sent length undefined. Exiting..." << endl;
@@ -112,30 +84,32 @@ double yisigraph_t::get_sentlength(int mode, int refid) {
 }
 */
 
-double yisigraph_t::get_sentsim(int mode, int refid) {
+double yisigraph_t::get_sentsim(int mode, int refid) const {
    double result = 0.0;
 
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return inpalignment_m[inpsrlgraph_m.get_root()].second;
+            return inpalignment_m[inpsrlgraph_p->get_root()].second;
          } else {
             return 0.0;
          }
          break;
       case yisi::HYP_MODE:
-         for (auto it = hypalignment_m[hypsrlgraph_m.get_root()].begin();
-               it != hypalignment_m[hypsrlgraph_m.get_root()].end(); it++) {
-            double s = (it->second).second;
-            if (s > result) {
-               result = s;
+         {
+            auto alignment = get_hypalignment(hypsrlgraph_p->get_root());
+            for (auto it = alignment.begin(); it != alignment.end(); it++) {
+               double s = (it->second).second;
+               if (s > result) {
+                  result = s;
+               }
             }
          }
          return result;
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return refalignment_m[refid][refsrlgraph_m[refid].get_root()].second;
+            return refalignment_m[refid][refsrlgraph_m[refid]->get_root()].second;
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0,"
                  << refsrlgraph_m.size() << "]. Sent sim undefined. Exiting..." << endl;
@@ -148,11 +122,11 @@ double yisigraph_t::get_sentsim(int mode, int refid) {
    }
 }
 
-vector<yisigraph_t::srlnid_type> yisigraph_t::get_preds(int mode, int refid) {
+vector<yisigraph_t::srlnid_type> yisigraph_t::get_preds(int mode, int refid) const {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return inpsrlgraph_m.get_preds();
+            return inpsrlgraph_p->get_preds();
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input predicates. Exiting..." << endl;
@@ -160,11 +134,11 @@ vector<yisigraph_t::srlnid_type> yisigraph_t::get_preds(int mode, int refid) {
          }
          break;
       case yisi::HYP_MODE:
-         return hypsrlgraph_m.get_preds();
+         return hypsrlgraph_p->get_preds();
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return refsrlgraph_m[refid].get_preds();
+            return refsrlgraph_m[refid]->get_preds();
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference predicates. Exiting..." << endl;
@@ -177,11 +151,11 @@ vector<yisigraph_t::srlnid_type> yisigraph_t::get_preds(int mode, int refid) {
    }
 }
 
-vector<yisigraph_t::srlnid_type> yisigraph_t::get_args(srlnid_type roleid, int mode, int refid) {
+vector<yisigraph_t::srlnid_type> yisigraph_t::get_args(srlnid_type roleid, int mode, int refid) const {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return inpsrlgraph_m.get_args(roleid);
+            return inpsrlgraph_p->get_args(roleid);
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input roles. Exiting..." << endl;
@@ -189,11 +163,11 @@ vector<yisigraph_t::srlnid_type> yisigraph_t::get_args(srlnid_type roleid, int m
          }
          break;
       case yisi::HYP_MODE:
-         return hypsrlgraph_m.get_args(roleid);
+         return hypsrlgraph_p->get_args(roleid);
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return refsrlgraph_m[refid].get_args(roleid);
+            return refsrlgraph_m[refid]->get_args(roleid);
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference roles. Exiting..." << endl;
@@ -211,7 +185,7 @@ vector<string>& yisigraph_t::get_sentence(int mode, int refid) {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return inpsrlgraph_m.get_sentence();
+            return inpsrlgraph_p->get_sentence();
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input sentence. Exiting..." << endl;
@@ -219,11 +193,11 @@ vector<string>& yisigraph_t::get_sentence(int mode, int refid) {
          }
          break;
       case yisi::HYP_MODE:
-         return hypsrlgraph_m.get_sentence();
+         return hypsrlgraph_p->get_sentence();
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return refsrlgraph_m[refid].get_sentence();
+            return refsrlgraph_m[refid]->get_sentence();
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference sentence. Exiting..." << endl;
@@ -237,11 +211,11 @@ vector<string>& yisigraph_t::get_sentence(int mode, int refid) {
 }
 */
 
-vector<string> yisigraph_t::get_role_filler_units(srlnid_type roleid, int mode, int refid) {
+vector<string> yisigraph_t::get_role_filler_units(srlnid_type roleid, int mode, int refid) const {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return inpsrlgraph_m.get_role_filler_units(roleid);
+            return inpsrlgraph_p->get_role_filler_units(roleid);
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input role fillers. Exiting..." << endl;
@@ -249,11 +223,11 @@ vector<string> yisigraph_t::get_role_filler_units(srlnid_type roleid, int mode,
          }
          break;
       case yisi::HYP_MODE:
-         return hypsrlgraph_m.get_role_filler_units(roleid);
+         return hypsrlgraph_p->get_role_filler_units(roleid);
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return refsrlgraph_m[refid].get_role_filler_units(roleid);
+            return refsrlgraph_m[refid]->get_role_filler_units(roleid);
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference role fillers. Exiting..." << endl;
@@ -266,11 +240,40 @@ vector<string> yisigraph_t::get_role_filler_units(srlnid_type roleid, int mode,
    }
 }
 
-double yisigraph_t::get_rolespanlength(srlnid_type roleid, int mode, int refid) {
+vector<tokid_type> yisigraph_t::get_role_filler_unitids(srlnid_type roleid, int mode, int refid) const {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return spanlength(inpsrlgraph_m.get_role_span(roleid));
+            return inpsrlgraph_p->get_role_filler_unitids(roleid);
+         } else {
+            cerr << "ERROR: YiSi graph with no input sentence. "
+                 << "Failed to get input role fillers. Exiting..." << endl;
+            exit(1);
+         }
+         break;
+      case yisi::HYP_MODE:
+         return hypsrlgraph_p->get_role_filler_unitids(roleid);
+         break;
+      case yisi::REF_MODE:
+         if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
+            return refsrlgraph_m[refid]->get_role_filler_unitids(roleid);
+         } else {
+            cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
+                 << "]. Failed to get reference role fillers. Exiting..." << endl;
+            exit(1);
+         }
+         break;
+      default:
+         cerr << "ERROR: Unknown mode in get role fillers. Contact Jackie. Exiting..." << endl;
+         exit(1);
+   }
+}
+
+double yisigraph_t::get_rolespanlength(srlnid_type roleid, int mode, int refid) const {
+   switch (mode) {
+      case yisi::INP_MODE:
+         if (inp_b) {
+            return spanlength(inpsrlgraph_p->get_role_span(roleid));
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input role span length. Exiting..." << endl;
@@ -278,11 +281,11 @@ double yisigraph_t::get_rolespanlength(srlnid_type roleid, int mode, int refid)
          }
          break;
       case yisi::HYP_MODE:
-         return spanlength(hypsrlgraph_m.get_role_span(roleid));
+         return spanlength(hypsrlgraph_p->get_role_span(roleid));
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return spanlength(refsrlgraph_m[refid].get_role_span(roleid));
+            return spanlength(refsrlgraph_m[refid]->get_role_span(roleid));
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference role span length. Exiting..." << endl;
@@ -295,11 +298,11 @@ double yisigraph_t::get_rolespanlength(srlnid_type roleid, int mode, int refid)
    }
 }
 
-yisigraph_t::label_type yisigraph_t::get_rolelabel(srlnid_type roleid, int mode, int refid) {
+yisigraph_t::labelid_type yisigraph_t::get_rolelabel(srlnid_type roleid, int mode, int refid) const {
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            return inpsrlgraph_m.get_role_label(roleid);
+            return inpsrlgraph_p->get_role_labelid(roleid);
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input role label. Exiting..." << endl;
@@ -307,11 +310,11 @@ yisigraph_t::label_type yisigraph_t::get_rolelabel(srlnid_type roleid, int mode,
          }
          break;
       case yisi::HYP_MODE:
-         return hypsrlgraph_m.get_role_label(roleid);
+         return hypsrlgraph_p->get_role_labelid(roleid);
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            return refsrlgraph_m[refid].get_role_label(roleid);
+            return refsrlgraph_m[refid]->get_role_labelid(roleid);
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference role label. Exiting..." << endl;
@@ -324,24 +327,20 @@ yisigraph_t::label_type yisigraph_t::get_rolelabel(srlnid_type roleid, int mode,
    }
 }
 
-vector<pair<int, yisigraph_t::alignment_type> > yisigraph_t::get_hypalignment(srlnid_type roleid) {
-   vector<pair<int, yisigraph_t::alignment_type> > result;
-   if (hypalignment_m.find(roleid) != hypalignment_m.end()) {
-      result = hypalignment_m[roleid];
+yisigraph_t::hypalignview_t yisigraph_t::get_hypalignment(srlnid_type roleid) const {
+   if (roleid + 1 < hypoffset_m.size()) {
+      return hypalignview_t(hypalignment_m.data() + hypoffset_m[roleid],
+                            hypalignment_m.data() + hypoffset_m[roleid + 1]);
    }
-   return result;
+   return hypalignview_t(NULL, NULL);
 }
 
-double yisigraph_t::get_alignsim(srlnid_type roleid, int mode, int refid) {
+double yisigraph_t::get_alignsim(srlnid_type roleid, int mode, int refid) const {
    double result = 0.0;
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            if (inpalignment_m.find(roleid) != inpalignment_m.end()) {
-               return inpalignment_m[roleid].second;
-            } else {
-               return 0.0;
-            }
+            return inpalignment_m[roleid].second;
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
                  << "Failed to get input alignment sim. Exiting..." << endl;
@@ -351,9 +350,9 @@ double yisigraph_t::get_alignsim(srlnid_type roleid, int mode, int refid) {
       case yisi::HYP_MODE:
          // return the maximum sim of all reference and input
          // better not to use this because it lost align label information
-         if (hypalignment_m.find(roleid) != hypalignment_m.end()) {
-            for (auto it = hypalignment_m[roleid].begin();
-                  it != hypalignment_m[roleid].end(); it++) {
+         {
+            auto alignment = get_hypalignment(roleid);
+            for (auto it = alignment.begin(); it != alignment.end(); it++) {
                double s = (it->second).second;
                if (s > result) {
                   result = s;
@@ -364,11 +363,7 @@ double yisigraph_t::get_alignsim(srlnid_type roleid, int mode, int refid) {
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            if (refalignment_m[refid].find(roleid) != refalignment_m[refid].end()) {
-               return refalignment_m[refid][roleid].second;
-            } else {
-               return 0.0;
-            }
+            return refalignment_m[refid][roleid].second;
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
                  << "]. Failed to get reference alignment sim. Exiting..." << endl;
@@ -381,17 +376,17 @@ double yisigraph_t::get_alignsim(srlnid_type roleid, int mode, int refid) {
    }
 }
 
-yisigraph_t::label_type yisigraph_t::get_alignlabel(srlnid_type roleid, int mode, int refid) {
+yisigraph_t::labelid_type yisigraph_t::get_alignlabel(srlnid_type roleid, int mode, int refid) const {
    double m = 0.0;
-   label_type result;
+   labelid_type result = UNLABELED;
 
    switch (mode) {
       case yisi::INP_MODE:
          if (inp_b) {
-            if (inpalignment_m.find(roleid) != inpalignment_m.end()) {
-               return hypsrlgraph_m.get_role_label(inpalignment_m[roleid].first);
+            if (inpalignment_m[roleid].first != UNALIGNED) {
+               return hypsrlgraph_p->get_role_labelid(inpalignment_m[roleid].first);
             } else {
-               return label_type("U");
+               return UNLABELED;
             }
          } else {
             cerr << "ERROR: YiSi graph with no input sentence. "
@@ -402,16 +397,16 @@ yisigraph_t::label_type yisigraph_t::get_alignlabel(srlnid_type roleid, int mode
       case yisi::HYP_MODE:
          // return the role label of the max align sim of all reference and input
          // better not to use this
-         if (hypalignment_m.find(roleid) != hypalignment_m.end()) {
-            for (auto it = hypalignment_m[roleid].begin();
-                  it != hypalignment_m[roleid].end(); it++) {
+         {
+            auto alignment = get_hypalignment(roleid);
+            for (auto it = alignment.begin(); it != alignment.end(); it++) {
                double s = (it->second).second;
                if (s > m) {
                   int id = it->first;
                   if (id < (int)refsrlgraph_m.size()) {
-                     result = refsrlgraph_m[id].get_role_label((it->second).first);
+                     result = refsrlgraph_m[id]->get_role_labelid((it->second).first);
                   } else {
-                     result = inpsrlgraph_m.get_role_label((it->second).first);
+                     result = inpsrlgraph_p->get_role_labelid((it->second).first);
                   }
                }
             }
@@ -420,10 +415,10 @@ yisigraph_t::label_type yisigraph_t::get_alignlabel(srlnid_type roleid, int mode
          break;
       case yisi::REF_MODE:
          if (-1 < refid && refid < (int)refsrlgraph_m.size()) {
-            if (refalignment_m[refid].find(roleid) != refalignment_m[refid].end()) {
-               return hypsrlgraph_m.get_role_label(refalignment_m[refid][roleid].first);
+            if (refalignment_m[refid][roleid].first != UNALIGNED) {
+               return hypsrlgraph_p->get_role_labelid(refalignment_m[refid][roleid].first);
             } else {
-               return label_type("U");
+               return UNLABELED;
             }
          } else {
             cerr << "ERROR: refid (" << refid << ") out of range [0," << refsrlgraph_m.size()
@@ -437,34 +432,59 @@ yisigraph_t::label_type yisigraph_t::get_alignlabel(srlnid_type roleid, int mode
    }
 }
 
-double yisigraph_t::spanlength(span_type span) {
+double yisigraph_t::spanlength(span_type span) const {
    return span.second - span.first;
 }
 
-void yisigraph_t::print(ostream& os) {
-   string h = yisi::join(hypsrlgraph_m.get_role_filler_units(hypsrlgraph_m.get_root()), " ");
+void yisigraph_t::set_hypalignment(const vector<vector<pair<srlnid_type, hypalignment_type> > >& alignments,
+                                   size_t n) {
+   // counting sort by hyp node, keeping the order of the alignments of a node
+   hypoffset_m.assign(hypsrlgraph_p->get_node_count() + 1, 0);
+   for (size_t k = 0; k < n; k++) {
+      for (auto it = alignments[k].begin(); it != alignments[k].end(); it++) {
+         hypoffset_m[it->first + 1]++;
+      }
+   }
+   for (size_t i = 1; i < hypoffset_m.size(); i++) {
+      hypoffset_m[i] += hypoffset_m[i - 1];
+   }
+   hypalignment_m.resize(hypoffset_m.back());
+   vector<size_t> next(hypoffset_m.begin(), hypoffset_m.end() - 1);
+   for (size_t k = 0; k < n; k++) {
+      for (auto it = alignments[k].begin(); it != alignments[k].end(); it++) {
+         hypalignment_m[next[it->first]++] = it->second;
+      }
+   }
+}
+
+void yisigraph_t::print(ostream& os) const {
+   string h = yisi::join(hypsrlgraph_p->get_role_filler_units(hypsrlgraph_p->get_root()), " ");
    //os << h <<endl;
    for (size_t i = 0; i < refalignment_m.size(); i++) {
-      string r = yisi::join(refsrlgraph_m[i].get_role_filler_units(refsrlgraph_m[i].get_root()), " ");
+      string r = yisi::join(refsrlgraph_m[i]->get_role_filler_units(refsrlgraph_m[i]->get_root()), " ");
       //os << r <<endl;
-      for (auto jt = refalignment_m[i].begin(); jt != refalignment_m[i].end(); jt++) {
-         auto refnid = jt->first;
-         auto hypnid = (jt->second).first;
-         double sim = (jt->second).second;
-         r = yisi::join(refsrlgraph_m[i].get_role_filler_units(refnid), " ");
-         h = yisi::join(hypsrlgraph_m.get_role_filler_units(hypnid), " ");
+      for (size_t refnid = 0; refnid < refalignment_m[i].size(); refnid++) {
+         auto hypnid = refalignment_m[i][refnid].first;
+         double sim = refalignment_m[i][refnid].second;
+         if (hypnid == UNALIGNED) {
+            continue;
+         }
+         r = yisi::join(refsrlgraph_m[i]->get_role_filler_units(refnid), " ");
+         h = yisi::join(hypsrlgraph_p->get_role_filler_units(hypnid), " ");
          os << r << "\t" << h << "\t" << sim << endl;
       }
    }
    if (inp_b) {
-      string inp = yisi::join(inpsrlgraph_m.get_role_filler_units(inpsrlgraph_m.get_root()), " ");
+      string inp = yisi::join(inpsrlgraph_p->get_role_filler_units(inpsrlgraph_p->get_root()), " ");
       os << inp << endl;
-      for (auto kt = inpalignment_m.begin(); kt != inpalignment_m.end(); kt++) {
-         auto inpnid = kt->first;
-         auto hypnid = (kt->second).first;
-         double sim = (kt->second).second;
-         inp = yisi::join(inpsrlgraph_m.get_role_filler_units(inpnid), " ");
-         h = yisi::join(hypsrlgraph_m.get_role_filler_units(hypnid), " ");
+      for (size_t inpnid = 0; inpnid < inpalignment_m.size(); inpnid++) {
+         auto hypnid = inpalignment_m[inpnid].first;
+         double sim = inpalignment_m[inpnid].second;
+         if (hypnid == UNALIGNED) {
+            continue;
+         }
+         inp = yisi::join(inpsrlgraph_p->get_role_filler_units(inpnid), " ");
+         h = yisi::join(hypsrlgraph_p->get_role_filler_units(hypnid), " ");
          os << inp << "\t" << h << "\t" << sim << endl;
       }
    }
@@ -8,6 +8,14 @@
  *    - yisigraph_t
  * and the function definition for the YiSi alignment algorithm.
  *
+ * A YiSi graph only borrows the SRL graphs it aligns, which must outlive it;
+ * copying or moving it copies the alignments, not the sentences.
+ *
+ * Node ids are dense, so the alignments of each reference and of the input
+ * are flat arrays indexed by node id, and those of the hypothesis are kept
+ * in compressed rows: the alignments of hyp node i are entries
+ * hypoffset_m[i] to hypoffset_m[i + 1] - 1, in the order they were made.
+ *
  * Multilingual Text Processing / Traitement multilingue de textes
  * Digital Technologies Research Centre / Centre de recherche en technologies numériques
  * National Research Council Canada / Conseil national de recherches Canada
@@ -21,8 +29,10 @@
 #include "srlgraph.h"
 #include "phrasesim.h"
 #include "maxmatching.h"
+#include "taskpool.h"
 
 #include <utility>
+#include <unordered_map>
 #include <string>
 #include <vector> 
 #include <iostream>
@@ -33,330 +43,299 @@ namespace yisi {
    public:
       typedef srlgraph_t::span_type span_type;
       typedef srlgraph_t::label_type label_type;
+      typedef srlgraph_t::labelid_type labelid_type;
       typedef srlgraph_t::srlnode_type srlnode_type;
       typedef srlgraph_t::srledge_type srledge_type;
       typedef srlgraph_t::srlnid_type srlnid_type;
       typedef srlgraph_t::srleid_type srleid_type;
       typedef std::pair<srlnid_type, double> alignment_type;
+      // alignment of a hyp node to a node of reference id, or of the input
+      // if id is the number of references
+      typedef std::pair<int, alignment_type> hypalignment_type;
+
+      // target of the nodes left unaligned
+      static const srlnid_type UNALIGNED = (srlnid_type)-1;
+      // label of no role, which matches no label
+      static const labelid_type UNLABELED = (labelid_type)-1;
+
+      // non-owning view of the alignments of a hyp node
+      struct hypalignview_t {
+         hypalignview_t(const hypalignment_type* begin, const hypalignment_type* end)
+            : begin_m(begin), end_m(end) {}
+         const hypalignment_type* begin() const { return begin_m; }
+         const hypalignment_type* end() const { return end_m; }
+         size_t size() const { return end_m - begin_m; }
+
+         const hypalignment_type* begin_m;
+         const hypalignment_type* end_m;
+      }; // struct hypalignview_t
 
-      yisigraph_t() {}
-      yisigraph_t(const std::vector<srlgraph_t> refsrlgraph, const srlgraph_t hypsrlgraph);
-      yisigraph_t(const std::vector<srlgraph_t> refsrlgraph, const srlgraph_t hypsrlgraph, const srlgraph_t inpsrlgraph);
-      yisigraph_t(const yisigraph_t& rhs);
-      void operator = (const yisigraph_t& rhs);
+      struct spanpair_hash {
+         size_t operator()(const std::pair<span_type, span_type>& key) const {
+            uint64_t h = mix_hash(key.first.first);
+            h = mix_hash(h ^ key.first.second);
+            h = mix_hash(h ^ key.second.first);
+            return mix_hash(h ^ key.second.second);
+         }
+      }; // struct spanpair_hash
+      // phrasal similarities of the role spans of one sentence pair
+      typedef std::unordered_map<std::pair<span_type, span_type>, std::pair<double, double>,
+                                 spanpair_hash> phrasesimmemo_type;
+
+      yisigraph_t() : hypsrlgraph_p(NULL), inpsrlgraph_p(NULL), inp_b(false) {}
+      // the graph borrows the srl graphs, which must outlive it; temporaries
+      // are turned down
+      yisigraph_t(const std::vector<srlgraph_t>& refsrlgraph, const srlgraph_t& hypsrlgraph);
+      yisigraph_t(const std::vector<srlgraph_t>& refsrlgraph, const srlgraph_t& hypsrlgraph,
+                  const srlgraph_t& inpsrlgraph);
+      yisigraph_t(std::vector<srlgraph_t>&& refsrlgraph, const srlgraph_t& hypsrlgraph) = delete;
+      yisigraph_t(const std::vector<srlgraph_t>& refsrlgraph, srlgraph_t&& hypsrlgraph) = delete;
+      yisigraph_t(std::vector<srlgraph_t>&& refsrlgraph, const srlgraph_t& hypsrlgraph,
+                  const srlgraph_t& inpsrlgraph) = delete;
+      yisigraph_t(const std::vector<srlgraph_t>& refsrlgraph, srlgraph_t&& hypsrlgraph,
+                  const srlgraph_t& inpsrlgraph) = delete;
+      yisigraph_t(const std::vector<srlgraph_t>& refsrlgraph, const srlgraph_t& hypsrlgraph,
+                  srlgraph_t&& inpsrlgraph) = delete;
 
-      template <typename T> void align(phrasesim_t<T>* phrasesim);
+      template <typename T>
+      void align(phrasesim_t<T>* phrasesim,
+                 const maxmatching_t::config_t& matching = maxmatching_t::config_t());
 
-      bool withinp();
-      size_t get_refsize();
+      bool withinp() const;
+      size_t get_refsize() const;
       // double get_sentlength(int mode, int refid=-1);
-      double get_sentsim(int mode, int refid=-1);
-      std::vector<srlnid_type> get_preds(int mode, int refid=-1);
-      std::vector<srlnid_type> get_args(srlnid_type roleid, int mode, int refid=-1);
+      double get_sentsim(int mode, int refid=-1) const;
+      std::vector<srlnid_type> get_preds(int mode, int refid=-1) const;
+      std::vector<srlnid_type> get_args(srlnid_type roleid, int mode, int refid=-1) const;
       // std::vector<std::string>& get_sentence(int mode, int refid=-1);
-      std::vector<std::string> get_role_filler_units(srlnid_type roleid, int mode, int refid=-1);
-      double get_rolespanlength(srlnid_type roleid, int mode, int refid=-1);
-      label_type get_rolelabel(srlnid_type roleid, int mode, int refid=-1);
-      std::vector<std::pair<int, alignment_type> > get_hypalignment(srlnid_type roleid);
-      double get_alignsim(srlnid_type roleid, int mode, int refid=-1);
-      label_type get_alignlabel(srlnid_type roleid, int mode, int refid=-1);
+      std::vector<std::string> get_role_filler_units(srlnid_type roleid, int mode, int refid=-1) const;
+      std::vector<tokid_type> get_role_filler_unitids(srlnid_type roleid, int mode, int refid=-1) const;
+      double get_rolespanlength(srlnid_type roleid, int mode, int refid=-1) const;
+      labelid_type get_rolelabel(srlnid_type roleid, int mode, int refid=-1) const;
+      hypalignview_t get_hypalignment(srlnid_type roleid) const;
+      double get_alignsim(srlnid_type roleid, int mode, int refid=-1) const;
+      // UNLABELED if roleid is not aligned
+      labelid_type get_alignlabel(srlnid_type roleid, int mode, int refid=-1) const;
 
-      void print(std::ostream& os);
+      void print(std::ostream& os) const;
 
    private:
-      double spanlength(span_type span);
-      std::vector<srlgraph_t> refsrlgraph_m;
-      srlgraph_t hypsrlgraph_m;
-      srlgraph_t inpsrlgraph_m;
+      // phrasal similarity of the fillers of s1id and hypid, memoized by their
+      // spans; the token similarities are read from sentsims, the s1 by hyp
+      // similarities of the units of the two sentences, which is filled on
+      // the first phrasal similarity missing from the caches
+      template <typename T>
+      std::pair<double, double> get_phrasesim(phrasesim_t<T>* phrasesim, phrasesimmemo_type& memo,
+                                              std::vector<double>& sentsims,
+                                              const srlgraph_t& s1graph, srlnid_type s1id,
+                                              srlnid_type hypid, int mode);
+      // aligns the frames of s1graph, reference id or the input if id is the
+      // number of references, to those of the hyp: fills s1alignment and
+      // adds the hyp side alignments to hypalignments
+      template <typename T>
+      void align_sentence(phrasesim_t<T>* phrasesim, const maxmatching_t::config_t& matching,
+                          const srlgraph_t& s1graph, int id, int mode,
+                          std::vector<alignment_type>& s1alignment,
+                          std::vector<std::pair<srlnid_type, hypalignment_type> >& hypalignments);
+      double spanlength(span_type span) const;
+      // lays out the hyp alignments of the first n slots, given by hyp node in
+      // the order they were made, in compressed rows
+      void set_hypalignment(const std::vector<std::vector<std::pair<srlnid_type, hypalignment_type> > >& alignments,
+                            size_t n);
+      std::vector<const srlgraph_t*> refsrlgraph_m;
+      const srlgraph_t* hypsrlgraph_p;
+      const srlgraph_t* inpsrlgraph_p;
 
-      std::vector<std::map<srlnid_type, alignment_type> > refalignment_m;
-      std::map<srlnid_type, std::vector<std::pair<int, alignment_type> > > hypalignment_m;
-      std::map<srlnid_type, alignment_type> inpalignment_m;
+      std::vector<std::vector<alignment_type> > refalignment_m;
+      std::vector<size_t> hypoffset_m;
+      std::vector<hypalignment_type> hypalignment_m;
+      std::vector<alignment_type> inpalignment_m;
       bool inp_b;
   }; // class yisigraph_t
   
    template <typename T>
-   void yisigraph_t::align(phrasesim_t<T>* phrasesim) {
-      //yisi alignment algorithm goes here
-      //loop all references and input
-      for (size_t refid = 0; refid < refsrlgraph_m.size(); refid++) {
-         //std::cerr << "first align the sentence node of ref" << refid << std::endl;
-         auto refroot = refsrlgraph_m[refid].get_root();
-         auto hyproot = hypsrlgraph_m.get_root();
+   std::pair<double, double> yisigraph_t::get_phrasesim(phrasesim_t<T>* phrasesim, phrasesimmemo_type& memo,
+                                                        std::vector<double>& sentsims,
+                                                        const srlgraph_t& s1graph, srlnid_type s1id,
+                                                        srlnid_type hypid, int mode) {
+      // the args of an aligned pred pair are compared in both directions, and
+      // the same spans recur across frames; the fillers are only built on a miss
+      auto key = std::make_pair(s1graph.get_role_span(s1id), hypsrlgraph_p->get_role_span(hypid));
+      auto it = memo.find(key);
+      if (it != memo.end()) {
+         return it->second;
+      }
+      auto s1phrase = s1graph.get_role_filler_unitids(s1id);
+      auto hypphrase = hypsrlgraph_p->get_role_filler_unitids(hypid);
+      bool uemb = s1graph.get_sent_type() == "uemb" && hypsrlgraph_p->get_sent_type() == "uemb";
+      // every filler is a run of the units of its sentence, so its token
+      // similarities are a block of those of the sentences
+      auto sims = [&]() {
+         if (sentsims.empty()) {
+            if (uemb) {
+               phrasesim->get_sims(s1graph.get_embs(), hypsrlgraph_p->get_embs(), sentsims);
+            } else {
+               phrasesim->get_sims(s1graph.get_unitids(), hypsrlgraph_p->get_unitids(), mode, sentsims);
+            }
+         }
+         size_t stride = hypsrlgraph_p->get_unit_size();
+         size_t offset = s1graph.get_role_uspan(s1id).first * stride
+            + hypsrlgraph_p->get_role_uspan(hypid).first;
+         return std::make_pair((const double*)sentsims.data() + offset, stride);
+      };
+      std::pair<double, double> result = (*phrasesim)(s1phrase, hypphrase, sims, mode);
+      memo[key] = result;
+      return result;
+   }
 
-         auto ru = refsrlgraph_m[refid].get_role_filler_units(refroot);
-         //std::cerr << "Got r " << ru.size() << std::endl;
-         auto hu = hypsrlgraph_m.get_role_filler_units(hyproot);
-         //std::cerr << "Got h " << hu.size() << std::endl;
-         std::pair<double, double> sentsim;
-         if (refsrlgraph_m[refid].get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-            //std::cerr<<"computing sentsim on word"<<std::endl;
-            sentsim = (*phrasesim)(ru, hu, yisi::REF_MODE);
+   template <typename T>
+   void yisigraph_t::align(phrasesim_t<T>* phrasesim, const maxmatching_t::config_t& matching) {
+      //yisi alignment algorithm goes here
+      //the references and the input are aligned independently, as tasks of
+      //the process-wide pool; each one collects its hyp side alignments in
+      //its own slot, in the order they are made, and the slots are laid out
+      //by hyp node at the end in reference then input order
+      static thread_local std::vector<std::vector<std::pair<srlnid_type, hypalignment_type> > > slots;
+      size_t nrefs = refsrlgraph_m.size();
+      size_t n = nrefs + (inp_b ? 1 : 0);
+      if (slots.size() < n) {
+         slots.resize(n);
+      }
+      //the tasks must see the slots of this thread, not their own
+      auto& hypalignments = slots;
+      refalignment_m.resize(nrefs);
+      get_taskpool().run(n, [&](size_t k) {
+         hypalignments[k].clear();
+         if (k < nrefs) {
+            align_sentence(phrasesim, matching, *refsrlgraph_m[k], k, yisi::REF_MODE,
+                           refalignment_m[k], hypalignments[k]);
          } else {
-            auto remb = refsrlgraph_m[refid].get_role_filler_embs(refroot);
-            auto hemb = hypsrlgraph_m.get_role_filler_embs(hyproot);
-            sentsim = (*phrasesim)(ru, hu, remb, hemb, yisi::REF_MODE);
+            align_sentence(phrasesim, matching, *inpsrlgraph_p, nrefs, yisi::INP_MODE,
+                           inpalignment_m, hypalignments[k]);
          }
+      });
+      set_hypalignment(hypalignments, n);
+   } // align
 
-         //std::cerr << "sentsim = (" << sentsim.first << "," << sentsim.second << ")";
-         //std::cerr << "refroot = " << refroot << std::endl;
-         //std::cerr << "hyproot = " << hyproot << std::endl;
-         refalignment_m.push_back(std::map<srlnid_type, alignment_type>());
-         //std::cerr << "Done creating refalignment map" << std::endl;
-         refalignment_m[refid][refroot] = alignment_type(hyproot, sentsim.second);
-         //std::cerr << "Done adding ref alignment edge" << std::endl;
-         if (hypalignment_m.find(hyproot) == hypalignment_m.end()) {
-            hypalignment_m[hyproot] = std::vector<std::pair<int, alignment_type> >();
-         }
-         hypalignment_m[hyproot].push_back(std::make_pair(refid, alignment_type(refroot, sentsim.first)));
-         //std::cerr << "Done adding hyp alignment edge" << std::endl;
-         //std::cerr << "prepare the pred maxmatching matrix"<<std::endl;
-         auto refpreds = refsrlgraph_m[refid].get_preds();
-         auto hyppreds = hypsrlgraph_m.get_preds();
-         maxmatching_t refpredmatch;
-         maxmatching_t hyppredmatch;
-         for (auto it = refpreds.begin(); it != refpreds.end(); it++) {
-            auto refpredid = *it;
-            auto refpredspan = refsrlgraph_m[refid].get_role_span(refpredid);
-            if (refpredspan.first != refpredspan.second) {
-               auto refpredphrase = refsrlgraph_m[refid].get_role_filler_units(refpredid);
-               for (auto jt = hyppreds.begin(); jt != hyppreds.end(); jt++) {
-                  auto hyppredid = *jt;
-                  auto hyppredspan = hypsrlgraph_m.get_role_span(hyppredid);
-                  if (hyppredspan.first != hyppredspan.second) {
-                     auto hyppredphrase = hypsrlgraph_m.get_role_filler_units(hyppredid);
-                     std::pair<double, double> predsim;
-                     if (refsrlgraph_m[refid].get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-                        predsim = (*phrasesim)(refpredphrase, hyppredphrase, yisi::REF_MODE);
-                     } else {
-                        auto rpredemb = refsrlgraph_m[refid].get_role_filler_embs(refpredid);
-                        auto hpredemb = hypsrlgraph_m.get_role_filler_embs(hyppredid);
-                        predsim = (*phrasesim)(refpredphrase, hyppredphrase, rpredemb, hpredemb, yisi::REF_MODE);
-                     }
-                     refpredmatch.add_weight(refpredid, hyppredid, predsim.second);
-                     hyppredmatch.add_weight(refpredid, hyppredid, predsim.first);
-                  }
-               } // for jt
-            }
-         }  // for it
-         //std::cerr <<"run maxmatch on preds" <<std::endl;
-         auto rpr = refpredmatch.run();
-         auto hpr = hyppredmatch.run();
-         //std::cerr <<"for each aligned pred" <<std::endl;
-         for (size_t i = 0; i < rpr.size(); i++) {
-            auto aligned_ref_pred = rpr[i].first.first;
-            auto aligned_hyp_pred = rpr[i].first.second;
-            auto psim = rpr[i].second;
-            refalignment_m[refid][aligned_ref_pred] = alignment_type(aligned_hyp_pred, psim);
-            //hypalignment_m[aligned_hyp_pred] = alignment_type(aligned_ref_pred, psim);
-            //std::cerr<<"prepare the arg maxmatching matrix"<<std::endl;
-            auto refargs = refsrlgraph_m[refid].get_args(aligned_ref_pred);
-            auto hypargs = hypsrlgraph_m.get_args(aligned_hyp_pred);
-            maxmatching_t argmatch;
-            for (auto it = refargs.begin(); it != refargs.end(); it++) {
-               auto refargid = *it;
-               auto refargphrase = refsrlgraph_m[refid].get_role_filler_units(refargid);
-               for (auto jt = hypargs.begin(); jt != hypargs.end(); jt++) {
-                  auto hypargid = *jt;
-                  auto hypargphrase = hypsrlgraph_m.get_role_filler_units(hypargid);
-                  std::pair<double, double> argsim;
-                  if (refsrlgraph_m[refid].get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-                     argsim = (*phrasesim)(refargphrase, hypargphrase, yisi::REF_MODE);
-                  } else {
-                     auto rargemb = refsrlgraph_m[refid].get_role_filler_embs(refargid);
-                     auto hargemb = hypsrlgraph_m.get_role_filler_embs(hypargid);
-                     argsim = (*phrasesim)(refargphrase, hypargphrase, rargemb, hargemb, yisi::REF_MODE);
-                  }
-                  argmatch.add_weight(refargid, hypargid, argsim.second);
-               } // for jt
-            } // for it
-            //std::cerr << "run maxmatch on args" <<std::endl;
-            auto ar = argmatch.run();
-            //std::cerr << "for each aligned arg" <<std::endl;
-            for (size_t j = 0; j < ar.size(); j++) {
-               auto aligned_ref_arg = ar[j].first.first;
-               auto aligned_hyp_arg = ar[j].first.second;
-               auto asim = ar[j].second;
-               refalignment_m[refid][aligned_ref_arg] = alignment_type(aligned_hyp_arg, asim);
-               //hypalignment_m[aligned_hyp_arg] = alignment_type(aligned_ref_arg, asim);
-            } // for j
-         } // for i
-         for (size_t i = 0; i < hpr.size(); i++) {
-            auto aligned_ref_pred = hpr[i].first.first;
-            auto aligned_hyp_pred = hpr[i].first.second;
-            auto psim = hpr[i].second;
-            if (hypalignment_m.find(aligned_hyp_pred) == hypalignment_m.end()) {
-               hypalignment_m[aligned_hyp_pred] = std::vector<std::pair<int, alignment_type> >();
-            }
-            hypalignment_m[aligned_hyp_pred].push_back(std::make_pair(refid,
-               alignment_type(aligned_ref_pred, psim)));
-            auto refargs = refsrlgraph_m[refid].get_args(aligned_ref_pred);
-            auto hypargs = hypsrlgraph_m.get_args(aligned_hyp_pred);
-            maxmatching_t argmatch;
-            for (auto it = refargs.begin(); it != refargs.end(); it++) {
-               auto refargid = *it;
-               auto refargphrase = refsrlgraph_m[refid].get_role_filler_units(refargid);
-               for (auto jt = hypargs.begin(); jt != hypargs.end(); jt++) {
-                  auto hypargid = *jt;
-                  auto hypargphrase = hypsrlgraph_m.get_role_filler_units(hypargid);
-                  std::pair<double, double> argsim;
-                  if (refsrlgraph_m[refid].get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-                     argsim = (*phrasesim)(refargphrase, hypargphrase, yisi::REF_MODE);
-                  } else {
-                     auto rargemb = refsrlgraph_m[refid].get_role_filler_embs(refargid);
-                     auto hargemb = hypsrlgraph_m.get_role_filler_embs(hypargid);
-                     argsim = (*phrasesim)(refargphrase, hypargphrase, rargemb, hargemb, yisi::REF_MODE);
-                  }
-                  argmatch.add_weight(refargid, hypargid, argsim.first);
-               } // for jt
-            } // for it
-            auto ar = argmatch.run();
-            for (size_t j = 0; j < ar.size(); j++) {
-               auto aligned_ref_arg = ar[j].first.first;
-               auto aligned_hyp_arg = ar[j].first.second;
-               auto asim = ar[j].second;
-               if (hypalignment_m.find(aligned_hyp_arg) == hypalignment_m.end()) {
-                  hypalignment_m[aligned_hyp_arg] =
-                     std::vector<std::pair<int, alignment_type> >();
+   template <typename T>
+   void yisigraph_t::align_sentence(phrasesim_t<T>* phrasesim, const maxmatching_t::config_t& matching,
+                                    const srlgraph_t& s1graph, int id, int mode,
+                                    std::vector<alignment_type>& s1alignment,
+                                    std::vector<std::pair<srlnid_type, hypalignment_type> >& hypalignments) {
+      //the matchers and their results are reused across frames and sentences,
+      //so that steady-state matching does not allocate
+      static thread_local maxmatching_t s1predmatch;
+      static thread_local maxmatching_t hyppredmatch;
+      static thread_local maxmatching_t s1argmatch;
+      static thread_local maxmatching_t hypargmatch;
+      static thread_local maxmatching_t::result_type s1pr;
+      static thread_local maxmatching_t::result_type hpr;
+      static thread_local maxmatching_t::result_type ar;
+      static thread_local std::vector<double> sentsims;
+      sentsims.clear();
+      s1predmatch.set_config(matching);
+      hyppredmatch.set_config(matching);
+      s1argmatch.set_config(matching);
+      hypargmatch.set_config(matching);
+      phrasesimmemo_type memo;
+
+      //first align the sentence nodes
+      auto s1root = s1graph.get_root();
+      auto hyproot = hypsrlgraph_p->get_root();
+      std::pair<double, double> sentsim = get_phrasesim(phrasesim, memo, sentsims, s1graph, s1root, hyproot, mode);
+      s1alignment.assign(s1graph.get_node_count(), alignment_type(UNALIGNED, 0.0));
+      s1alignment[s1root] = alignment_type(hyproot, sentsim.second);
+      hypalignments.push_back(std::make_pair(hyproot,
+         hypalignment_type(id, alignment_type(s1root, sentsim.first))));
+
+      //match the preds one way on the recall and the other on the precision
+      //side of the same similarities
+      auto s1preds = s1graph.get_preds();
+      auto hyppreds = hypsrlgraph_p->get_preds();
+      s1predmatch.clear();
+      hyppredmatch.clear();
+      for (auto it = s1preds.begin(); it != s1preds.end(); it++) {
+         auto s1predid = *it;
+         auto s1predspan = s1graph.get_role_span(s1predid);
+         if (s1predspan.first != s1predspan.second) {
+            for (auto jt = hyppreds.begin(); jt != hyppreds.end(); jt++) {
+               auto hyppredid = *jt;
+               auto hyppredspan = hypsrlgraph_p->get_role_span(hyppredid);
+               if (hyppredspan.first != hyppredspan.second) {
+                  std::pair<double, double> predsim =
+                     get_phrasesim(phrasesim, memo, sentsims, s1graph, s1predid, hyppredid, mode);
+                  s1predmatch.add_weight(s1predid, hyppredid, predsim.second);
+                  hyppredmatch.add_weight(s1predid, hyppredid, predsim.first);
                }
-               hypalignment_m[aligned_hyp_arg].push_back(std::make_pair(refid,
-                  alignment_type(aligned_ref_arg, asim)));
-            }  // for j
-         } // for i
-      } // for refid
-      //input
-      if (inp_b) {
-         //std::cerr << "first align the sentence node of inp: ";
-         auto inproot = inpsrlgraph_m.get_root();
-         auto hyproot = hypsrlgraph_m.get_root();
-         auto r = inpsrlgraph_m.get_role_filler_units(inproot);
-         //std::cerr<< r.size();
-         auto h = hypsrlgraph_m.get_role_filler_units(hyproot);
-         //std::cerr<< h.size();
-         std::pair<double, double> sentsim;
-         if (inpsrlgraph_m.get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-            sentsim = (*phrasesim)(r, h, yisi::INP_MODE);
-         } else {
-            auto remb = inpsrlgraph_m.get_role_filler_embs(inproot);
-            auto hemb = hypsrlgraph_m.get_role_filler_embs(hyproot);
-            //std::cerr<< remb.size() <<" " <<hemb.size();
-            sentsim = (*phrasesim)(r, h, remb, hemb, yisi::INP_MODE);
+            } // for jt
          }
-         //std::cerr << "sentsim = (" << sentsim.first << "," << sentsim.second << ")";
-         inpalignment_m[inproot] = alignment_type(hyproot, sentsim.second);
-         if (hypalignment_m.find(hyproot) == hypalignment_m.end()) {
-            hypalignment_m[hyproot] = std::vector<std::pair<int, alignment_type> >();
+      } // for it
+      s1predmatch.run(s1pr);
+      hyppredmatch.run(hpr);
+
+      //both matchings list the s1 preds in the order they were added, so
+      //they are walked together; when an s1 pred is aligned to the same hyp
+      //pred both ways, the args are compared once for both arg matchings
+      size_t i = 0;
+      size_t j = 0;
+      for (auto it = s1preds.begin(); it != s1preds.end(); it++) {
+         auto s1predid = *it;
+         bool s1aligned = i < s1pr.size() && s1pr[i].first.first == s1predid;
+         bool hypaligned = j < hpr.size() && hpr[j].first.first == s1predid;
+         bool shared = s1aligned && hypaligned && s1pr[i].first.second == hpr[j].first.second;
+         if (!s1aligned && !hypaligned) {
+            continue;
          }
-         hypalignment_m[hyproot].push_back(std::make_pair((int)refsrlgraph_m.size(),
-            alignment_type(inproot, sentsim.first)));
-         auto inppreds = inpsrlgraph_m.get_preds();
-         auto hyppreds = hypsrlgraph_m.get_preds();
-         maxmatching_t inppredmatch;
-         maxmatching_t hyppredmatch;
-         for (auto it = inppreds.begin(); it != inppreds.end(); it++) {
-            auto inppredid = *it;
-            auto inppredspan = inpsrlgraph_m.get_role_span(inppredid);
-            if (inppredspan.first != inppredspan.second) {
-               auto inppredphrase = inpsrlgraph_m.get_role_filler_units(inppredid);
-               for (auto jt = hyppreds.begin(); jt != hyppreds.end(); jt++) {
-                  auto hyppredid = *jt;
-                  auto hyppredspan = hypsrlgraph_m.get_role_span(hyppredid);
-                  if (hyppredspan.first != hyppredspan.second) {
-                     auto hyppredphrase = hypsrlgraph_m.get_role_filler_units(hyppredid);
-                     std::pair<double, double> predsim;
-                     if (inpsrlgraph_m.get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-                        predsim = (*phrasesim)(inppredphrase, hyppredphrase, yisi::INP_MODE);
-                     } else {
-                        auto ipredemb = inpsrlgraph_m.get_role_filler_embs(inppredid);
-                        auto hpredemb = hypsrlgraph_m.get_role_filler_embs(hyppredid);
-                        predsim = (*phrasesim)(inppredphrase, hyppredphrase, ipredemb, hpredemb, yisi::INP_MODE);
-                     }
-                     inppredmatch.add_weight(inppredid, hyppredid, predsim.second);
-                     hyppredmatch.add_weight(inppredid, hyppredid, predsim.first);
+         auto s1args = s1graph.get_args(s1predid);
+         s1argmatch.clear();
+         hypargmatch.clear();
+         if (s1aligned) {
+            auto aligned_hyp_pred = s1pr[i].first.second;
+            s1alignment[s1predid] = alignment_type(aligned_hyp_pred, s1pr[i].second);
+            auto hypargs = hypsrlgraph_p->get_args(aligned_hyp_pred);
+            for (auto at = s1args.begin(); at != s1args.end(); at++) {
+               for (auto bt = hypargs.begin(); bt != hypargs.end(); bt++) {
+                  std::pair<double, double> argsim =
+                     get_phrasesim(phrasesim, memo, sentsims, s1graph, *at, *bt, mode);
+                  s1argmatch.add_weight(*at, *bt, argsim.second);
+                  if (shared) {
+                     hypargmatch.add_weight(*at, *bt, argsim.first);
                   }
-               }
-            }
+               } // for bt
+            } // for at
          }
-         auto ipr = inppredmatch.run();
-         auto hpr = hyppredmatch.run();
-         for (size_t i = 0; i < ipr.size(); i++) {
-            auto aligned_inp_pred = ipr[i].first.first;
-            auto aligned_hyp_pred = ipr[i].first.second;
-            auto psim = ipr[i].second;
-            inpalignment_m[aligned_inp_pred] = alignment_type(aligned_hyp_pred, psim);
-            auto inpargs = inpsrlgraph_m.get_args(aligned_inp_pred);
-            auto hypargs = hypsrlgraph_m.get_args(aligned_hyp_pred);
-            maxmatching_t argmatch;
-            for (auto it = inpargs.begin(); it != inpargs.end(); it++) {
-               auto inpargid = *it;
-               auto inpargphrase = inpsrlgraph_m.get_role_filler_units(inpargid);
-               for (auto jt = hypargs.begin(); jt != hypargs.end(); jt++) {
-                  auto hypargid = *jt;
-                  auto hypargphrase = hypsrlgraph_m.get_role_filler_units(hypargid);
-                  std::pair<double, double> argsim;
-                  if (inpsrlgraph_m.get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-                     argsim = (*phrasesim)(inpargphrase, hypargphrase, yisi::INP_MODE);
-                  } else {
-                     auto iargemb = inpsrlgraph_m.get_role_filler_embs(inpargid);
-                     auto hargemb = hypsrlgraph_m.get_role_filler_embs(hypargid);
-                     argsim = (*phrasesim)(inpargphrase, hypargphrase, iargemb, hargemb, yisi::INP_MODE);
-                  }
-                  argmatch.add_weight(inpargid, hypargid, argsim.second);
-               }
-            }
-            auto ar = argmatch.run();
-            for (size_t j = 0; j < ar.size(); j++) {
-               auto aligned_inp_arg = ar[j].first.first;
-               auto aligned_hyp_arg = ar[j].first.second;
-               auto asim = ar[j].second;
-               inpalignment_m[aligned_inp_arg] = alignment_type(aligned_hyp_arg, asim);
+         if (hypaligned) {
+            auto aligned_hyp_pred = hpr[j].first.second;
+            hypalignments.push_back(std::make_pair(aligned_hyp_pred,
+               hypalignment_type(id, alignment_type(s1predid, hpr[j].second))));
+            if (!shared) {
+               auto hypargs = hypsrlgraph_p->get_args(aligned_hyp_pred);
+               for (auto at = s1args.begin(); at != s1args.end(); at++) {
+                  for (auto bt = hypargs.begin(); bt != hypargs.end(); bt++) {
+                     std::pair<double, double> argsim =
+                        get_phrasesim(phrasesim, memo, sentsims, s1graph, *at, *bt, mode);
+                     hypargmatch.add_weight(*at, *bt, argsim.first);
+                  } // for bt
+               } // for at
             }
          }
-         for (size_t i = 0; i < hpr.size(); i++) {
-            auto aligned_inp_pred = hpr[i].first.first;
-            auto aligned_hyp_pred = hpr[i].first.second;
-            auto psim = hpr[i].second;
-            if (hypalignment_m.find(aligned_hyp_pred) == hypalignment_m.end()) {
-               hypalignment_m[aligned_hyp_pred] =
-                  std::vector<std::pair<int, alignment_type> >();
-            }
-            hypalignment_m[aligned_hyp_pred].push_back(std::make_pair((int)refsrlgraph_m.size(),
-               alignment_type(aligned_inp_pred, psim)));
-            auto inpargs = inpsrlgraph_m.get_args(aligned_inp_pred);
-            auto hypargs = hypsrlgraph_m.get_args(aligned_hyp_pred);
-            maxmatching_t argmatch;
-            for (auto it = inpargs.begin(); it != inpargs.end(); it++) {
-               auto inpargid = *it;
-               auto inpargphrase = inpsrlgraph_m.get_role_filler_units(inpargid);
-               for (auto jt = hypargs.begin(); jt != hypargs.end(); jt++) {
-                  auto hypargid = *jt;
-                  auto hypargphrase = hypsrlgraph_m.get_role_filler_units(hypargid);
-                  std::pair<double, double> argsim;
-                  if (inpsrlgraph_m.get_sent_type() != "uemb" ||  hypsrlgraph_m.get_sent_type() != "uemb") {
-                     argsim = (*phrasesim)(inpargphrase, hypargphrase, yisi::INP_MODE);
-                  } else {
-                     auto iargemb = inpsrlgraph_m.get_role_filler_embs(inpargid);
-                     auto hargemb = hypsrlgraph_m.get_role_filler_embs(hypargid);
-                     argsim = (*phrasesim)(inpargphrase, hypargphrase, iargemb, hargemb, yisi::INP_MODE);
-                  }
-                  argmatch.add_weight(inpargid, hypargid, argsim.first);
-               }
+         if (s1aligned) {
+            s1argmatch.run(ar);
+            for (size_t k = 0; k < ar.size(); k++) {
+               s1alignment[ar[k].first.first] = alignment_type(ar[k].first.second, ar[k].second);
             }
-            auto ar = argmatch.run();
-            for (size_t j = 0; j < ar.size(); j++) {
-               auto aligned_inp_arg = ar[j].first.first;
-               auto aligned_hyp_arg = ar[j].first.second;
-               auto asim = ar[j].second;
-               if (hypalignment_m.find(aligned_hyp_arg) == hypalignment_m.end()) {
-                  hypalignment_m[aligned_hyp_arg] =
-                     std::vector<std::pair<int, alignment_type> >();
-               }
-               hypalignment_m[aligned_hyp_arg].push_back(std::make_pair((int)refsrlgraph_m.size(),
-                  alignment_type(aligned_inp_arg, asim)));
+            i++;
+         }
+         if (hypaligned) {
+            hypargmatch.run(ar);
+            for (size_t k = 0; k < ar.size(); k++) {
+               hypalignments.push_back(std::make_pair(ar[k].first.second,
+                  hypalignment_type(id, alignment_type(ar[k].first.first, ar[k].second))));
             }
+            j++;
          }
-      }
-   } // align
+      } // for it
+   } // align_sentence
 
    std::ostream& operator<<(std::ostream& os, const yisi::yisigraph_t& m);
   
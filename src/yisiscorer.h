@@ -45,6 +45,10 @@ namespace yisi {
       double alpha_m;
       double beta_m;
 
+      std::string matching_name_m;
+      double matching_epsilon_m;
+      size_t matching_sample_m;
+
       void init(com::masaers::cmdlp::parser& p) {
          using namespace com::masaers::cmdlp;
 
@@ -112,6 +116,25 @@ namespace yisi {
 	   .desc("Ratio of precision & recall in YiSi")
 	   .name("alpha")
 	   ;
+         p.add(make_knob(matching_name_m))
+	   .fallback("exact")
+	   .desc("Type of predicate and argument matching: [exact(default)"
+	         "|greedy: at least half the exact weight, faster on long sentences]")
+	   .name("matching")
+	   ;
+         p.add(make_knob(matching_sample_m))
+	   .fallback(1000)
+	   .desc("With greedy matching, also match every this many matchings exactly "
+	         "and report how close greedy came [1000(default)|0: never]")
+	   .name("matching-sample")
+	   ;
+         p.add(make_knob(matching_epsilon_m))
+	   .fallback(-1.0)
+	   .desc("Drop predicate and argument pairs with similarity at most this "
+	         "and match each connected component of the rest separately "
+	         "[<0(default): match densely]")
+	   .name("matching-epsilon")
+	   ;
       }
    }; // struct yisi_options
 
@@ -127,6 +150,14 @@ namespace yisi {
          frameweight_name_m = opt.frameweight_name_m;
          alpha_m = opt.alpha_m;
          beta_m = opt.beta_m;
+         if (opt.matching_name_m != "exact" && opt.matching_name_m != "greedy") {
+            std::cerr << "ERROR: Unknown matching type " << opt.matching_name_m
+                      << ". Exiting..." << std::endl;
+            exit(1);
+         }
+         matching_m.greedy_m = opt.matching_name_m == "greedy";
+         matching_m.epsilon_m = opt.matching_epsilon_m;
+         matching_m.sample_m = opt.matching_sample_m;
 
          int i = 0;
          if (opt.labelconfig_path_m != "") {
@@ -144,7 +175,11 @@ namespace yisi {
                   while (!iss.eof()) {
                      std::string label;
                      iss >> label;
-                     label_m[label] = i;
+                     auto labelid = get_labelvocab().intern(label);
+                     if (labelid >= labelclass_m.size()) {
+                        labelclass_m.resize(labelid + 1, -1);
+                     }
+                     labelclass_m[labelid] = i;
                   }
                   i++;
                }
@@ -224,26 +259,18 @@ namespace yisi {
          phrasesim_p->readcache();
       }
 
+      void prepare(bool inp) {
+         phrasesim_p->prepare(inp);
+      }
+
       void estimate_weight(std::vector<srlgraph_t> srls) {
          for (auto it = srls.begin(); it != srls.end(); it++) {
             auto preds = it->get_preds();
             for (auto jt = preds.begin(); jt != preds.end(); jt++) {
-               auto pred_label = it->get_role_label(*jt);
-               if (label_m.find(pred_label) == label_m.end()) {
-                  std::cerr << "ERROR: Unknown predicate label '" << pred_label
-                     << "'. Check your labelconfig. Exiting..." << std::endl;
-                  exit(1);
-               }
-               weight_m[label_m[pred_label]] += 0.25;
+               weight_m[get_labelclass(it->get_role_labelid(*jt))] += 0.25;
                auto args = it->get_args(*jt);
                for (auto kt = args.begin(); kt != args.end(); kt++) {
-                  auto arg_label = it->get_role_label(*kt);
-                  if (label_m.find(arg_label) == label_m.end()) {
-                     std::cerr << "ERROR: Unknown argument label '" << arg_label
-                        << "'. Check your labelconfig. Exiting..." << std::endl;
-                     exit(1);
-                  }
-                  weight_m[label_m[arg_label]] += 1.0;
+                  weight_m[get_labelclass(it->get_role_labelid(*kt))] += 1.0;
                }
             }
          }
@@ -259,6 +286,7 @@ namespace yisi {
          //std::cerr << "Tokenizing/SRL-ing the input ...";
          std::vector<srlgraph_t> result = inpsrl_p->parse(inpsents);
          //std::cerr << "Done." << std::endl;
+         check_labels(result);
          if (weightconfig_path_m == "") {
             this->estimate_weight(result);
          }
@@ -269,6 +297,7 @@ namespace yisi {
          //std::cerr << "Tokenizing/SRL-ing the references ... ";
          std::vector<srlgraph_t> result = refsrl_p->parse(refsents);
          //std::cerr << "Done." << std::endl;
+         check_labels(result);
          if (weightconfig_path_m == "") {
             this->estimate_weight(result);
          }
@@ -279,6 +308,7 @@ namespace yisi {
          //std::cerr << "Tokenizing/SRL-ing the hypotheses ... ";
          std::vector<srlgraph_t> result = hypsrl_p->parse(hypsents);
          //std::cerr << "Done." << std::endl;
+         check_labels(result);
          return result;
       }
 
@@ -286,31 +316,43 @@ namespace yisi {
          //std::cerr <<"Tokenizing/SRL-ing the hypothesis ... ";
          srlgraph_t result = hypsrl_p->parse(hypsent);
          //std::cerr << "Done." << std::endl;
+         check_labels(result);
          return result;
       }
 
-      yisigraph_t align(const std::vector<srlgraph_t> refsrlgraph, const srlgraph_t hypsrlgraph) {
+      // the result borrows the srl graphs, which must outlive it; temporaries
+      // are turned down
+      yisigraph_t align(std::vector<srlgraph_t>&& refsrlgraph, const srlgraph_t& hypsrlgraph) = delete;
+      yisigraph_t align(const std::vector<srlgraph_t>& refsrlgraph, srlgraph_t&& hypsrlgraph) = delete;
+      yisigraph_t align(std::vector<srlgraph_t>&& refsrlgraph, const srlgraph_t& hypsrlgraph,
+                        const srlgraph_t& inpsrlgraph) = delete;
+      yisigraph_t align(const std::vector<srlgraph_t>& refsrlgraph, srlgraph_t&& hypsrlgraph,
+                        const srlgraph_t& inpsrlgraph) = delete;
+      yisigraph_t align(const std::vector<srlgraph_t>& refsrlgraph, const srlgraph_t& hypsrlgraph,
+                        srlgraph_t&& inpsrlgraph) = delete;
+
+      yisigraph_t align(const std::vector<srlgraph_t>& refsrlgraph, const srlgraph_t& hypsrlgraph) {
          //std::cerr << "Creating YiSi graph ... ";
          yisigraph_t result(refsrlgraph, hypsrlgraph);
          //std::cerr << "start aligning ... ";
-         result.align(phrasesim_p);
+         result.align(phrasesim_p, matching_m);
          //result.print(std::cerr);
          //std::cerr << "Done." << std::endl;
          return result;
       }
 
-      yisigraph_t align(const std::vector<srlgraph_t> refsrlgraph,
-                        const srlgraph_t hypsrlgraph, const srlgraph_t inpsrlgraph) {
+      yisigraph_t align(const std::vector<srlgraph_t>& refsrlgraph,
+                        const srlgraph_t& hypsrlgraph, const srlgraph_t& inpsrlgraph) {
          //std::cerr << "Creating YiSi graph with input... ";
          yisigraph_t result(refsrlgraph, hypsrlgraph, inpsrlgraph);
          //std::cerr << "start aligning ... ";
-         result.align(phrasesim_p);
+         result.align(phrasesim_p, matching_m);
          //result.print(std::cerr);
          //std::cerr << "Done." << std::endl;
          return result;
       };
 
-      double score(yisigraph_t& yg) {
+      double score(const yisigraph_t& yg) {
          double precision = score(yg, yisi::HYP_MODE);
          double recall = score(yg, yisi::REF_MODE);
          double yisi = 0.0;
@@ -361,7 +403,7 @@ namespace yisi {
          //}
       }
 
-      std::vector<double> features(yisigraph_t& yg) {
+      std::vector<double> features(const yisigraph_t& yg) {
          std::vector<double> result;
          //double flat =  yg.get_sentsim();
          //result.push_back(flat);
@@ -378,7 +420,7 @@ namespace yisi {
       }
 
    private:
-      double score(yisigraph_t yg, int mode) {
+      double score(const yisigraph_t& yg, int mode) {
          //std::cerr <<"Scoring...";
          auto f = features(yg, mode);
          double structure = f[weight_m.size()];
@@ -476,7 +518,7 @@ namespace yisi {
          //}
       }
 
-      std::vector<double> features(yisigraph_t yg, int mode) {
+      std::vector<double> features(const yisigraph_t& yg, int mode) {
          if (mode == yisi::REF_MODE) {
             return rfeatures(yg);
          } else {
@@ -484,7 +526,7 @@ namespace yisi {
          }
       }
 
-      void compute_features(yisigraph_t yg, std::vector<double> feats,
+      void compute_features(const yisigraph_t& yg, std::vector<double> feats,
          double& structure, double& flat, int mode, int refid = -1) {
          flat = yg.get_sentsim(mode, refid);
 
@@ -502,7 +544,7 @@ namespace yisi {
             auto predid = *it;
             double sanity_check = yg.get_rolespanlength(predid, mode, refid);
             double predsim = yg.get_alignsim(predid, mode, refid);
-            auto predlabel = yg.get_rolelabel(predid, mode, refid);
+            int predclass = get_labelclass(yg.get_rolelabel(predid, mode, refid));
             double predweight = get_roleweight(yg, predid, mode, refid);
 
             if (sanity_check > 0) {
@@ -510,11 +552,11 @@ namespace yisi {
                double fw = yg.get_rolespanlength(predid, mode, refid);
                double fn = 0.0;
 
-               sim[label_m[predlabel]] += predsim;
+               sim[predclass] += predsim;
                fn = predweight * predsim;
 
                double fd = predweight;
-               count[label_m[predlabel]] += 1.0;
+               count[predclass] += 1.0;
 
                auto args = yg.get_args(predid, mode, refid);
                for (auto jt = args.begin(); jt != args.end(); jt++) {
@@ -523,13 +565,12 @@ namespace yisi {
 
                   auto arglabel = yg.get_rolelabel(argid, mode, refid);
                   double argsim = 0.0;
-                  yisigraph_t::label_type alignlabel;
                   if (mode == yisi::HYP_MODE) {
                      auto alignment = yg.get_hypalignment(argid);
                      for (auto it = alignment.begin(); it != alignment.end(); it++) {
                         double s = (it->second).second;
                         int id = it->first;
-                        yisigraph_t::label_type l;
+                        yisigraph_t::labelid_type l;
                         if (id < (int)yg.get_refsize()) {
                            l = yg.get_rolelabel((it->second).first, yisi::REF_MODE, id);
                         } else {
@@ -537,20 +578,18 @@ namespace yisi {
                         }
                         if (s > argsim && match(arglabel, l)) {
                            argsim = s;
-                           alignlabel = l;
                         }
                      }
                   } else {
-                     alignlabel = yg.get_alignlabel(argid, mode, refid);
                      argsim = yg.get_alignsim(argid, mode, refid);
                   }
 
                   double argweight = get_roleweight(yg, argid, mode, refid);
 
-                  sim[label_m[arglabel]] += argsim;
+                  sim[get_labelclass(arglabel)] += argsim;
                   fn += argweight * argsim;
 
-                  count[label_m[arglabel]] += 1.0;
+                  count[get_labelclass(arglabel)] += 1.0;
                   fd += argweight;
                }
 
@@ -593,7 +632,7 @@ namespace yisi {
          }
       }
 
-      std::vector<double> pfeatures(yisigraph_t yg) {
+      std::vector<double> pfeatures(const yisigraph_t& yg) {
          std::vector<double> result(weight_m.size(), 0.0);
          double structure = 0.0;
          double flat = 0.0;
@@ -605,7 +644,7 @@ namespace yisi {
          return result;
       }
 
-      std::vector<double> rfeatures(yisigraph_t yg) {
+      std::vector<double> rfeatures(const yisigraph_t& yg) {
          std::vector<double> result(weight_m.size(), 0.0);
          double mflat = 0.0;
          double mstructure = 0.0;
@@ -649,36 +688,52 @@ namespace yisi {
          return result;
       }
 
-      bool match(std::string label1, std::string label2) {
-         if (label1 == "U" || label2 == "U") {
+      bool match(yisigraph_t::labelid_type label1, yisigraph_t::labelid_type label2) {
+         if (label1 == yisigraph_t::UNLABELED || label2 == yisigraph_t::UNLABELED) {
             return false;
          } else {
-            if (label_m.find(label1) == label_m.end()) {
-               std::cerr << "ERROR: Unknown srl label '" << label1 << "' in YiSi for matching label 1. "
-                  << "Check your labelconfig. Exiting..." << std::endl;
-               exit(1);
-            }
-            if (label_m.find(label2) == label_m.end()) {
-               std::cerr << "ERROR: unknown srl label '" << label2 << "' in yisi for matching label 2. "
-                  << "Check your labelconfig. Exiting..." << std::endl;
-               exit(1);
+            return get_labelclass(label1) == get_labelclass(label2);
+         }
+      }
+
+      // class of labelid in the labelconfig, -1 if it is not there
+      int get_labelclass(srlgraph_t::labelid_type labelid) const {
+         return labelid < labelclass_m.size() ? labelclass_m[labelid] : -1;
+      }
+
+      // every label of the graphs must be in the labelconfig, so that the
+      // scoring only meets known classes
+      void check_labels(const srlgraph_t& srl) const {
+         auto preds = srl.get_preds();
+         for (auto it = preds.begin(); it != preds.end(); it++) {
+            check_label(srl.get_role_labelid(*it), "predicate");
+            auto args = srl.get_args(*it);
+            for (auto jt = args.begin(); jt != args.end(); jt++) {
+               check_label(srl.get_role_labelid(*jt), "argument");
             }
-            return (label_m[label1] == label_m[label2]);
          }
       }
 
-      double get_roleweight(yisigraph_t yg, size_t roleid, int mode, int refid = -1) {
+      void check_labels(const std::vector<srlgraph_t>& srls) const {
+         for (auto it = srls.begin(); it != srls.end(); it++) {
+            check_labels(*it);
+         }
+      }
+
+      void check_label(srlgraph_t::labelid_type labelid, const std::string& role) const {
+         if (get_labelclass(labelid) < 0) {
+            std::cerr << "ERROR: Unknown " << role << " label '" << get_labelvocab().get_token(labelid)
+               << "'. Check your labelconfig. Exiting..." << std::endl;
+            exit(1);
+         }
+      }
+
+      double get_roleweight(const yisigraph_t& yg, size_t roleid, int mode, int refid = -1) {
          if (weightconfig_path_m == "lexweight") {
-            auto fillers = yg.get_role_filler_units(roleid, mode, refid);
+            auto fillers = yg.get_role_filler_unitids(roleid, mode, refid);
             return phrasesim_p->get_lexweight(fillers, mode);
          } else {
-            std::string label = yg.get_rolelabel(roleid, mode, refid);
-            if (label_m.find(label) == label_m.end()) {
-               std::cerr << "ERROR: Unknown srl label '" << label << "' in yisi for get_weight. "
-                  << "Check your labelconfig. Exiting..." << std::endl;
-               exit(1);
-            }
-            return weight_m[label_m[label]];
+            return weight_m[get_labelclass(yg.get_rolelabel(roleid, mode, refid))];
          }
       }
 
@@ -695,10 +750,12 @@ namespace yisi {
       std::string frameweight_name_m;
       //std::string prfunc_name_m;
 
-      std::map<std::string, int> label_m;
+      // class of each label id in the labelconfig, -1 for the labels not in it
+      std::vector<int> labelclass_m;
       std::vector<double> weight_m;
       double alpha_m;
       double beta_m;
+      maxmatching_t::config_t matching_m;
    }; // class yisiscorer_t
   
 } // yisi